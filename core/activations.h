@@ -5,6 +5,12 @@
 #include <cassert>
 #include <algorithm>
 #include "tensor.h"
+#include "sparse_tensor.h"
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define DNN_ACTIVATION_AVX2 1
+#endif
 
 #ifndef M_PI
 #define M_PI 3.14159265358979323846
@@ -30,6 +36,11 @@ enum class ActivationType {
 
 /*
  * Activation layer (stateless except cached input/output)
+ *
+ * RELU and LEAKY_RELU backward only need sign(x), so they cache a
+ * 1-bit-per-element mask of x > 0 instead of fp32 input/output
+ * tensors (32x less activation memory); STEP, whose derivative is 0,
+ * caches nothing. The other types keep input_cache / output_cache.
  */
 class Activation {
 public:
@@ -42,6 +53,10 @@ public:
     Tensor input_cache;
     Tensor output_cache;
 
+    // RELU / LEAKY_RELU: x > 0 of the last input (for RELU also the
+    // non-zero pattern of the output); STEP: shape only
+    BitMask mask;
+
     Activation(
         ActivationType t,
         float alpha_ = 0.01f,
@@ -51,30 +66,87 @@ public:
     /*
      * Forward pass
      */
-    Tensor forward(const Tensor& X) {
-        input_cache = X;
-        Tensor Y(X.rows, X.cols);
-
-        for (int i = 0; i < X.rows; ++i) {
-            for (int j = 0; j < X.cols; ++j) {
-                float x = X(i, j);
-                Y(i, j) = activate(x);
-            }
+    Tensor forward(const TensorView& X) {
+        Tensor Y;
+        forward_into(X, Y);
+        return Y;
+    }
+
+    // As forward(), into Y (resized, reusing its allocation)
+    void forward_into(const TensorView& X, Tensor& Y) {
+        if (!X.contiguous()) {
+            forward_into(to_tensor(X), Y);
+            return;
         }
 
+        Y.resize(X.rows, X.cols);
+        forward(X.data, Y.data.data(), X.rows, X.cols);
+
+        if (masked()) {
+            input_cache.clear();
+            output_cache.clear();
+            return;
+        }
+
+        input_cache.assign(X);
+        output_cache = Y;
+    }
+
+    /*
+     * Forward pass on caller buffers: Y = f(X), both (rows x cols)
+     * Only the mask is recorded; backward_inplace() is handed X and Y
+     * again (see Model::compile's memory plan).
+     */
+    void forward(const float* X, float* Y, int rows, int cols) {
+        const size_t n = static_cast<size_t>(rows) * cols;
+        for (size_t i = 0; i < n; ++i) Y[i] = activate(X[i]);
+
         // Special handling for softmax (row-wise)
         if (type == ActivationType::SOFTMAX) {
-            softmax(Y);
+            softmax(Y, rows, cols);
         }
 
-        output_cache = Y;
-        return Y;
+        if (type == ActivationType::STEP) {
+            mask = BitMask();
+            mask.rows = rows;
+            mask.cols = cols;
+        } else if (masked()) {
+            mask.build_positive(X, rows, cols, cols);
+        }
+    }
+
+    /*
+     * Non-zero pattern of the last output, or nullptr when this
+     * activation does not track one (only RELU does)
+     */
+    const BitMask* output_nonzeros() const {
+        return type == ActivationType::RELU ? &mask : nullptr;
+    }
+
+    // Bytes held for backward
+    size_t cache_bytes() const {
+        return (input_cache.data.size() + output_cache.data.size()) * sizeof(float) + mask.bytes();
+    }
+
+    // Free the fp32 caches (forward must run again before backward);
+    // the mask is kept, the next layer may still read it
+    void release() {
+        input_cache.clear();
+        output_cache.clear();
     }
 
     /*
      * Backward pass
      */
-    Tensor backward(const Tensor& dOut) {
+    Tensor backward(const TensorView& dOut) {
+        if (masked()) {
+            assert(dOut.rows == mask.rows);
+            assert(dOut.cols == mask.cols);
+            Tensor dX = to_tensor(dOut);
+            mask_gradient(dX.data.data(), dX.rows, dX.cols);
+            return dX;
+        }
+
         assert(dOut.rows == output_cache.rows);
         assert(dOut.cols == output_cache.cols);
 
@@ -82,7 +154,7 @@ public:
 
         // Softmax backward usually combined with cross-entropy
         if (type == ActivationType::SOFTMAX) {
-            return dOut;
+            return to_tensor(dOut);
         }
 
         for (int i = 0; i < dOut.rows; ++i) {
@@ -95,7 +167,79 @@ public:
         return dX;
     }
 
+    /*
+     * Backward pass on caller buffers: dOut *= f'(X), in place
+     * X, Y: as given to forward(X, Y, rows, cols); only read by types
+     * that need them (reads_input / reads_output)
+     */
+    void backward_inplace(float* dOut, const float* X, const float* Y, int rows, int cols) const {
+        if (masked()) {
+            assert(rows == mask.rows && cols == mask.cols);
+            mask_gradient(dOut, rows, cols);
+            return;
+        }
+        if (type == ActivationType::SOFTMAX || type == ActivationType::LINEAR) return;
+
+        const size_t n = static_cast<size_t>(rows) * cols;
+        for (size_t i = 0; i < n; ++i)
+            dOut[i] *= derivative(reads_input() ? X[i] : 0.0f, reads_output() ? Y[i] : 0.0f);
+    }
+
+    // Whether backward_inplace() reads the forward input / output
+    bool reads_input() const {
+        switch (type) {
+            case ActivationType::PRELU:
+            case ActivationType::ELU:
+            case ActivationType::SELU:
+            case ActivationType::GELU:
+            case ActivationType::SWISH:
+                return true;
+            default:
+                return false;
+        }
+    }
+
+    bool reads_output() const {
+        return type == ActivationType::SIGMOID || type == ActivationType::TANH;
+    }
+
 private:
+    bool masked() const {
+        return type == ActivationType::RELU || type == ActivationType::LEAKY_RELU ||
+               type == ActivationType::STEP;
+    }
+
+    /*
+     * g = g where x > 0, else 0 (RELU) / alpha * g (LEAKY_RELU), in
+     * place; 8 lanes at a time, a mask byte expanded to lanes for a blend
+     */
+    void mask_gradient(float* g, int rows, int cols) const {
+        if (type == ActivationType::STEP) {
+            std::fill(g, g + static_cast<size_t>(rows) * cols, 0.0f);
+            return;
+        }
+
+        const float low = type == ActivationType::LEAKY_RELU ? alpha : 0.0f;
+        for (int i = 0; i < rows; ++i) {
+            const uint64_t* bits = mask.row(i);
+            float* d = g + static_cast<size_t>(i) * cols;
+            int j = 0;
+#ifdef DNN_ACTIVATION_AVX2
+            const __m256i lane_bit = _mm256_setr_epi32(1, 2, 4, 8, 16, 32, 64, 128);
+            const __m256 low_v = _mm256_set1_ps(low);
+            for (; j + 8 <= cols; j += 8) {
+                const int byte = static_cast<int>(bits[j / 64] >> (j % 64) & 0xFF);
+                __m256i sel = _mm256_and_si256(_mm256_set1_epi32(byte), lane_bit);
+                __m256 on = _mm256_castsi256_ps(_mm256_cmpeq_epi32(sel, lane_bit));
+                __m256 v = _mm256_loadu_ps(d + j);
+                _mm256_storeu_ps(d + j, _mm256_blendv_ps(_mm256_mul_ps(v, low_v), v, on));
+            }
+#endif
+            for (; j < cols; ++j)
+                d[j] = (bits[j / 64] >> (j % 64) & 1) ? d[j] : low * d[j];
+        }
+    }
+
     /*
      * Activation functions
      */
@@ -195,23 +339,24 @@ private:
     }
 
     /*
-     * Row-wise softmax (numerically stable)
+     * Row-wise softmax (numerically stable), X: (rows x cols)
      */
-    void softmax(Tensor& X) const {
-        for (int i = 0; i < X.rows; ++i) {
-            float max_val = X(i, 0);
-            for (int j = 1; j < X.cols; ++j) {
-                max_val = std::max(max_val, X(i, j));
+    void softmax(float* X, int rows, int cols) const {
+        for (int i = 0; i < rows; ++i) {
+            float* x = X + static_cast<size_t>(i) * cols;
+            float max_val = x[0];
+            for (int j = 1; j < cols; ++j) {
+                max_val = std::max(max_val, x[j]);
             }
 
             float sum = 0.0f;
-            for (int j = 0; j < X.cols; ++j) {
-                X(i, j) = std::exp(X(i, j) - max_val);
-                sum += X(i, j);
+            for (int j = 0; j < cols; ++j) {
+                x[j] = std::exp(x[j] - max_val);
+                sum += x[j];
             }
 
-            for (int j = 0; j < X.cols; ++j) {
-                X(i, j) /= sum;
+            for (int j = 0; j < cols; ++j) {
+                x[j] /= sum;
             }
         }
     }
@@ -0,0 +1,358 @@
+#pragma once
+
+#include <vector>
+#include <cmath>
+#include <cstdint>
+#include <algorithm>
+#include <cassert>
+
+#include "tensor.h"
+#include "dense_layer.h"
+
+#if defined(__AVX512VPOPCNTDQ__) && defined(__AVX512VL__)
+#include <immintrin.h>
+#define DNN_BINARY_POPCNT512 1
+#elif defined(__AVX2__)
+#include <immintrin.h>
+#define DNN_BINARY_AVX2 1
+#endif
+
+/*
+ * Binary / ternary dense layers (XNOR-Net style)
+ *
+ * Weights are constrained to alpha_j * {-1, +1} (BINARY) or
+ * alpha_j * {-1, 0, +1} (TERNARY) with a per-output-channel scale
+ * alpha_j, and the layer input is binarized per row with a scale
+ * beta_i (see InputBinarization). Bits pack 64 per word:
+ *   x bit      x > 0
+ *   sign bit   W > 0               (1 = +1, 0 = -1)
+ *   mask bit   W != 0              (ternary only)
+ * so with K inputs and sign-binarized x
+ *   BINARY:  dot = popcount(xnor(x, s)) - popcount(xor(x, s))
+ *                = K - 2 popcount(x ^ s)
+ *   TERNARY: dot = nnz_j - 2 popcount((x ^ s) & m)
+ * and with {0, 1} x (AND instead of XNOR)
+ *   BINARY:  dot = 2 popcount(x & s) - popcount(x)
+ *   TERNARY: dot = 2 popcount(x & s & m) - popcount(x & m)
+ *   out_ij = beta_i * alpha_j * dot + b_j
+ *
+ * Training keeps the fp32 W (W_param) as latent weights and uses the
+ * straight-through estimator: forward runs the binarized layer,
+ * backward treats sign() as the identity, zeroing gradients where
+ * |W| or |x| exceeds ste_clip (hardtanh). sync_weights() re-packs
+ * after every optimizer step, so Model::fit trains these layers as-is.
+ *
+ * Rows of bits are padded to 256 (4 words) for the SIMD popcount:
+ * vpopcntq with AVX-512 VPOPCNTDQ, a nibble-LUT vpshufb popcount with
+ * AVX2, __builtin_popcountll otherwise.
+ */
+enum class WeightBinarization {
+    BINARY,    // {-1, +1}
+    TERNARY    // {-1, 0, +1}
+};
+
+/*
+ * How the layer input is binarized
+ *   SIGN:      beta * sign(x)   in {-beta, +beta}   (xor / xnor)
+ *   POSITIVE:  beta * [x > 0]   in {0, beta}        (and), for
+ *              non-negative inputs such as ReLU / STEP outputs
+ */
+enum class InputBinarization {
+    SIGN,
+    POSITIVE
+};
+
+namespace binary_detail {
+
+static const int CHUNK_WORDS = 4;   // 256 bits
+
+/*
+ * Bits x > 0 of x[0..K) into bits[0..words) (zero padded)
+ * Returns the row's scale: mean |x| (SIGN) or the mean of the
+ * positive entries (POSITIVE, where negatives are clamped to 0).
+ */
+inline float binarize_row(const float* x, int K, uint64_t* bits, int words,
+                          InputBinarization encoding) {
+    std::fill(bits, bits + words, 0ULL);
+    const bool positive = encoding == InputBinarization::POSITIVE;
+    float abs_sum = 0.0f;
+    int k = 0;
+#if defined(DNN_BINARY_POPCNT512) || defined(DNN_BINARY_AVX2)
+    const __m256 zero = _mm256_setzero_ps();
+    const __m256 abs_mask = _mm256_castsi256_ps(_mm256_set1_epi32(0x7fffffff));
+    __m256 acc = _mm256_setzero_ps();
+    for (; k + 8 <= K; k += 8) {
+        __m256 v = _mm256_loadu_ps(x + k);
+        uint64_t m = static_cast<uint32_t>(_mm256_movemask_ps(_mm256_cmp_ps(v, zero, _CMP_GT_OQ)));
+        bits[k / 64] |= m << (k % 64);
+        acc = _mm256_add_ps(acc, positive ? _mm256_max_ps(v, zero) : _mm256_and_ps(v, abs_mask));
+    }
+    float lanes[8];
+    _mm256_storeu_ps(lanes, acc);
+    for (float v : lanes) abs_sum += v;
+#endif
+    for (; k < K; ++k) {
+        if (x[k] > 0.0f) bits[k / 64] |= 1ULL << (k % 64);
+        abs_sum += positive ? std::max(x[k], 0.0f) : std::fabs(x[k]);
+    }
+    if (!positive) return K > 0 ? abs_sum / K : 0.0f;
+
+    int ones = 0;
+    for (int w = 0; w < words; ++w) ones += __builtin_popcountll(bits[w]);
+    return ones > 0 ? abs_sum / ones : 0.0f;
+}
+
+#if defined(DNN_BINARY_POPCNT512) || defined(DNN_BINARY_AVX2)
+// Per-64-bit-lane popcount
+inline __m256i popcount_epi64(__m256i v) {
+#ifdef DNN_BINARY_POPCNT512
+    return _mm256_popcnt_epi64(v);
+#else
+    const __m256i lut = _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+                                         0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+    const __m256i low = _mm256_set1_epi8(0x0f);
+    __m256i lo = _mm256_and_si256(v, low);
+    __m256i hi = _mm256_and_si256(_mm256_srli_epi16(v, 4), low);
+    __m256i bytes = _mm256_add_epi8(_mm256_shuffle_epi8(lut, lo), _mm256_shuffle_epi8(lut, hi));
+    return _mm256_sad_epu8(bytes, _mm256_setzero_si256());
+#endif
+}
+
+inline int hsum_epi64(__m256i v) {
+    __m128i s = _mm_add_epi64(_mm256_castsi256_si128(v), _mm256_extracti128_si256(v, 1));
+    return static_cast<int>(_mm_cvtsi128_si64(s) + _mm_extract_epi64(s, 1));
+}
+#endif
+
+/*
+ * Bit combinations the kernels count
+ *   XOR:      a ^ b             (binary, sign input)
+ *   XOR_MASK: (a ^ b) & m       (ternary, sign input)
+ *   AND:      a & b             (binary, positive input)
+ *   AND_MASK: a & b & m         (ternary, positive input)
+ */
+enum BitOp { XOR, XOR_MASK, AND, AND_MASK };
+
+template <int Op>
+inline uint64_t combine(uint64_t a, uint64_t b, uint64_t m) {
+    uint64_t v = (Op == XOR || Op == XOR_MASK) ? a ^ b : a & b;
+    return (Op == XOR_MASK || Op == AND_MASK) ? v & m : v;
+}
+
+// popcount(combine<Op>(a, b, m)) over `words` (multiple of CHUNK_WORDS)
+template <int Op>
+inline int popcount(const uint64_t* a, const uint64_t* b, const uint64_t* m, int words) {
+#if defined(DNN_BINARY_POPCNT512) || defined(DNN_BINARY_AVX2)
+    __m256i acc = _mm256_setzero_si256();
+    for (int w = 0; w < words; w += CHUNK_WORDS) {
+        __m256i va = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + w));
+        __m256i vb = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + w));
+        __m256i v = (Op == XOR || Op == XOR_MASK) ? _mm256_xor_si256(va, vb) : _mm256_and_si256(va, vb);
+        if (Op == XOR_MASK || Op == AND_MASK)
+            v = _mm256_and_si256(v, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(m + w)));
+        acc = _mm256_add_epi64(acc, popcount_epi64(v));
+    }
+    return hsum_epi64(acc);
+#else
+    int n = 0;
+    for (int w = 0; w < words; ++w)
+        n += __builtin_popcountll(combine<Op>(a[w], b[w], m ? m[w] : 0ULL));
+    return n;
+#endif
+}
+
+} // namespace binary_detail
+
+class BinaryDenseLayer : public DenseLayer {
+public:
+    WeightBinarization mode;
+    InputBinarization input_encoding;
+    float ste_clip = 1.0f;   // STE gradient window; <= 0 disables clipping
+
+    BinaryDenseLayer(int input_dim, int output_dim,
+                     ActivationType act_type = ActivationType::LINEAR,
+                     WeightBinarization mode_ = WeightBinarization::BINARY,
+                     InputBinarization input_encoding_ = InputBinarization::SIGN)
+        : DenseLayer(input_dim, output_dim, act_type),
+          mode(mode_),
+          input_encoding(input_encoding_),
+          words((input_dim + 255) / 256 * binary_detail::CHUNK_WORDS) {
+        pack();
+    }
+
+    using DenseLayer::forward;
+
+    /*
+     * Re-binarize W into the packed bits and scales
+     * (call after writing W directly; fit() does it per step)
+     */
+    void pack() {
+        const int K = W.rows, N = W.cols;
+        sign_bits.assign(static_cast<size_t>(N) * words, 0ULL);
+        mask_bits.assign(mode == WeightBinarization::TERNARY ? static_cast<size_t>(N) * words : 0, 0ULL);
+        alpha.assign(N, 0.0f);
+        nonzeros.assign(N, K);
+
+        for (int j = 0; j < N; ++j) {
+            uint64_t* s = &sign_bits[static_cast<size_t>(j) * words];
+            float mean_abs = 0.0f;
+            for (int k = 0; k < K; ++k) {
+                mean_abs += std::fabs(W(k, j));
+                if (W(k, j) > 0.0f) s[k / 64] |= 1ULL << (k % 64);
+            }
+            mean_abs /= K;
+
+            if (mode == WeightBinarization::BINARY) {
+                alpha[j] = mean_abs;
+                continue;
+            }
+
+            // Ternary weight networks: threshold 0.7 E|w|, scale = mean kept |w|
+            uint64_t* m = &mask_bits[static_cast<size_t>(j) * words];
+            const float delta = 0.7f * mean_abs;
+            float kept = 0.0f;
+            int nnz = 0;
+            for (int k = 0; k < K; ++k) {
+                if (std::fabs(W(k, j)) <= delta) continue;
+                m[k / 64] |= 1ULL << (k % 64);
+                kept += std::fabs(W(k, j));
+                nnz++;
+            }
+            nonzeros[j] = nnz;
+            alpha[j] = nnz > 0 ? kept / nnz : 0.0f;
+        }
+    }
+
+    // nz is unused: binarized inputs are dense bit rows
+    void forward_into(const float* X, int rows, int ld, const BitMask*, Tensor& Y) override {
+        assert(ld >= W.rows);
+        const int K = W.rows, N = W.cols;
+
+        sparse_input = nullptr;
+        input_mask = nullptr;
+        input_ptr = X;
+        input_rows = rows;
+        input_ld = ld;
+
+        input_bits.resize(static_cast<size_t>(rows) * words);
+        input_scale.resize(rows);
+        for (int i = 0; i < rows; ++i)
+            input_scale[i] = binary_detail::binarize_row(X + static_cast<size_t>(i) * ld, K,
+                                                         &input_bits[static_cast<size_t>(i) * words],
+                                                         words, input_encoding);
+
+        using namespace binary_detail;
+        const bool ternary = mode == WeightBinarization::TERNARY;
+        Tensor out(rows, N);
+        for (int i = 0; i < rows; ++i) {
+            const uint64_t* x = &input_bits[static_cast<size_t>(i) * words];
+            const int ones = input_encoding == InputBinarization::POSITIVE
+                                 ? popcount<AND>(x, x, nullptr, words) : 0;
+            for (int j = 0; j < N; ++j) {
+                const uint64_t* s = &sign_bits[static_cast<size_t>(j) * words];
+                const uint64_t* m = ternary ? &mask_bits[static_cast<size_t>(j) * words] : nullptr;
+                int dot;
+                if (input_encoding == InputBinarization::SIGN)
+                    dot = ternary ? nonzeros[j] - 2 * popcount<XOR_MASK>(x, s, m, words)
+                                  : K - 2 * popcount<XOR>(x, s, nullptr, words);
+                else
+                    dot = ternary ? 2 * popcount<AND_MASK>(x, s, m, words) - popcount<AND>(x, m, nullptr, words)
+                                  : 2 * popcount<AND>(x, s, nullptr, words) - ones;
+                out(i, j) = input_scale[i] * alpha[j] * dot;
+            }
+        }
+        add_bias(out, b);
+        activation.forward_into(out, Y);
+    }
+
+    // Sparse inputs are binarized from their dense rows
+    void forward_into(const SparseTensor& X, Tensor& Y) override {
+        input_cache = X.to_dense();
+        forward_into(input_cache.data.data(), X.rows, X.cols, nullptr, Y);
+    }
+
+    /*
+     * Straight-through backward
+     *   dW = Xb^T * dOut_activated   (|W| <= ste_clip)
+     *   dX = dOut_activated * Wb^T   (|x| <= ste_clip)
+     * Xb, Wb: the binarized input and weights
+     */
+    Tensor backward(const Tensor& dOut) override {
+        assert(dOut.cols == W.cols);
+        assert(dOut.rows == input_rows);
+        const int K = W.rows, N = W.cols, rows = input_rows;
+
+        Tensor dOut_activated = activation.backward(dOut);
+
+        Tensor Xb(rows, K);
+        for (int i = 0; i < rows; ++i) {
+            const float low = input_encoding == InputBinarization::SIGN ? -input_scale[i] : 0.0f;
+            const uint64_t* x = &input_bits[static_cast<size_t>(i) * words];
+            for (int k = 0; k < K; ++k)
+                Xb(i, k) = (x[k / 64] >> (k % 64) & 1) ? input_scale[i] : low;
+        }
+        gemm_tn(Xb.data.data(), rows, K, K, dOut_activated.data.data(), N, grad_W.data.data());
+        if (ste_clip > 0.0f)
+            for (size_t i = 0; i < grad_W.data.size(); ++i)
+                if (std::fabs(W.data[i]) > ste_clip) grad_W.data[i] = 0.0f;
+
+        bias_gradient(dOut_activated);
+        sync_gradients();
+
+        Tensor Wb_T(N, K);
+        for (int j = 0; j < N; ++j)
+            for (int k = 0; k < K; ++k)
+                Wb_T(j, k) = alpha[j] * weight(k, j);
+
+        Tensor dX(rows, K);
+        gemm(dOut_activated.data.data(), rows, N, N, Wb_T.data.data(), K, dX.data.data());
+        if (ste_clip > 0.0f)
+            for (int i = 0; i < rows; ++i) {
+                const float* x = input_ptr + static_cast<size_t>(i) * input_ld;
+                for (int k = 0; k < K; ++k)
+                    if (std::fabs(x[k]) > ste_clip) dX(i, k) = 0.0f;
+            }
+        return dX;
+    }
+
+    // Runs through its own forward / backward only
+    bool plannable() const override {
+        return false;
+    }
+
+    // Backward reads the fp32 input rows
+    bool bf16_input_only() const override {
+        return false;
+    }
+
+    void sync_weights() override {
+        DenseLayer::sync_weights();
+        pack();
+    }
+
+    // Binarized weight (-1, 0 or +1) of entry (k, j)
+    int weight(int k, int j) const {
+        const size_t w = static_cast<size_t>(j) * words + k / 64;
+        const int bit = k % 64;
+        if (mode == WeightBinarization::TERNARY && !(mask_bits[w] >> bit & 1)) return 0;
+        return (sign_bits[w] >> bit & 1) ? 1 : -1;
+    }
+
+    float scale(int j) const { return alpha[j]; }
+
+    // Packed weight storage: bits + per-channel scales
+    size_t packed_bytes() const {
+        return (sign_bits.size() + mask_bits.size()) * sizeof(uint64_t) +
+               alpha.size() * sizeof(float) + nonzeros.size() * sizeof(int);
+    }
+
+private:
+    int words;                          // per bit row, multiple of CHUNK_WORDS
+    std::vector<uint64_t> sign_bits;    // (output_dim x words), bit k: W(k, j) > 0
+    std::vector<uint64_t> mask_bits;    // (output_dim x words), bit k: W(k, j) kept (ternary)
+    std::vector<float> alpha;           // per output channel
+    std::vector<int> nonzeros;          // kept weights per output channel
+
+    std::vector<uint64_t> input_bits;   // (rows x words), cached for backward
+    std::vector<float> input_scale;     // beta per row
+};
@@ -0,0 +1,257 @@
+#pragma once
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <future>
+#include <random>
+#include <numeric>
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <cassert>
+
+#include "dataset.h"
+
+/*
+ * Aligned (64 bytes by default) buffer that is locked in RAM when possible
+ * (mlock / VirtualLock), so staging memory is never paged out
+ * between being gathered and being trained on.
+ */
+struct StagingBuffer {
+    char* ptr = nullptr;
+    size_t bytes = 0;
+    bool pinned = false;
+
+    StagingBuffer() = default;
+    StagingBuffer(const StagingBuffer&) = delete;
+    StagingBuffer& operator=(const StagingBuffer&) = delete;
+
+    ~StagingBuffer() { release(); }
+
+    void allocate(size_t n, size_t alignment = 64) {
+        release();
+        bytes = (n + alignment - 1) / alignment * alignment;
+#ifdef _WIN32
+        ptr = static_cast<char*>(_aligned_malloc(bytes, alignment));
+        pinned = ptr && VirtualLock(ptr, bytes);
+#else
+        ptr = static_cast<char*>(std::aligned_alloc(alignment, bytes));
+        pinned = ptr && mlock(ptr, bytes) == 0;
+#endif
+        assert(ptr && "StagingBuffer allocation failed");
+        std::memset(ptr, 0, bytes);
+    }
+
+    void release() {
+        if (!ptr) return;
+#ifdef _WIN32
+        if (pinned) VirtualUnlock(ptr, bytes);
+        _aligned_free(ptr);
+#else
+        if (pinned) munlock(ptr, bytes);
+        std::free(ptr);
+#endif
+        ptr = nullptr;
+        bytes = 0;
+        pinned = false;
+    }
+};
+
+/*
+ * Asynchronous prefetching loader over a record Dataset
+ *
+ * Background workers gather the next `prefetch` batches (in a
+ * shuffled order, by index permutation) into a ring of staging
+ * buffers while the current batch trains. Batches come out in the
+ * same order regardless of which worker gathered them, so a run is
+ * reproducible from `seed`.
+ *
+ * The permutation for epoch e+1 is built in the background during
+ * epoch e.
+ */
+class DataLoader : public BatchSource {
+public:
+    DataLoader(const Dataset& data,
+               int batch_size,
+               bool shuffle = true,
+               unsigned seed = 0,
+               int prefetch = 4,
+               int num_workers = 2)
+        : data(data),
+          batch_size(batch_size),
+          shuffle(shuffle),
+          seed(seed),
+          num_workers(std::max(1, num_workers)),
+          slots(std::max(2, prefetch)) {
+
+        row_stride = (data.num_features() + 15) / 16 * 16;   // 64-byte rows
+        size_t feature_bytes = static_cast<size_t>(batch_size) * row_stride * sizeof(float);
+        for (auto& slot : slots) {
+            slot.buffer.allocate(feature_bytes + batch_size * sizeof(int32_t));
+        }
+    }
+
+    ~DataLoader() override { stop_workers(); }
+
+    int num_features() const override { return data.num_features(); }
+
+    void start_epoch(int epoch) override {
+        stop_workers();
+
+        if (next_order.valid() && next_order_epoch == epoch)
+            order = next_order.get();
+        else
+            order = make_order(epoch);
+
+        if (shuffle) {
+            next_order_epoch = epoch + 1;
+            next_order = std::async(std::launch::async,
+                                    [this, epoch] { return make_order(epoch + 1); });
+        }
+
+        num_batches = (data.size() + batch_size - 1) / batch_size;
+        next_claim = 0;
+        consumed = 0;
+        for (auto& slot : slots) {
+            slot.batch = -1;
+            slot.ready = false;
+        }
+        stopping = false;
+
+        for (int w = 0; w < num_workers; ++w)
+            workers.emplace_back(&DataLoader::worker_loop, this);
+    }
+
+    bool next(BatchView& batch) override {
+        std::unique_lock<std::mutex> lock(mtx);
+
+        // The previous view is no longer in use; let its slot refill
+        if (consumed > 0) {
+            slots[(consumed - 1) % slots.size()].ready = false;
+            slot_free.notify_all();
+        }
+        if (consumed >= num_batches) return false;
+
+        Slot& slot = slots[consumed % slots.size()];
+        if (!(slot.ready && slot.batch == consumed)) {
+            stalls++;
+            slot_ready.wait(lock, [&] { return slot.ready && slot.batch == consumed; });
+        }
+
+        batch.features = reinterpret_cast<const float*>(slot.buffer.ptr);
+        batch.labels = reinterpret_cast<const int32_t*>(
+            slot.buffer.ptr + static_cast<size_t>(batch_size) * row_stride * sizeof(float));
+        batch.rows = slot.rows;
+        batch.cols = data.num_features();
+        batch.stride = row_stride;
+        batch.label_stride = 1;
+
+        consumed++;
+        return true;
+    }
+
+    // Times next() had to wait for a worker (0 means data never stalled training)
+    int64_t stall_count() const { return stalls; }
+
+    bool staging_pinned() const { return slots.front().buffer.pinned; }
+
+private:
+    struct Slot {
+        StagingBuffer buffer;
+        int64_t batch = -1;
+        int rows = 0;
+        bool ready = false;
+    };
+
+    const Dataset& data;
+    int batch_size;
+    bool shuffle;
+    unsigned seed;
+    int num_workers;
+    int row_stride = 0;
+
+    std::vector<Slot> slots;
+    std::vector<int64_t> order;
+    std::future<std::vector<int64_t>> next_order;
+    int next_order_epoch = -1;
+
+    std::vector<std::thread> workers;
+    std::mutex mtx;
+    std::condition_variable slot_free;
+    std::condition_variable slot_ready;
+
+    int64_t num_batches = 0;
+    int64_t next_claim = 0;   // next batch a worker will gather
+    int64_t consumed = 0;     // batches handed out by next()
+    int64_t stalls = 0;
+    bool stopping = false;
+
+    std::vector<int64_t> make_order(int epoch) const {
+        std::vector<int64_t> idx(data.size());
+        std::iota(idx.begin(), idx.end(), 0);
+        if (shuffle) {
+            std::mt19937_64 rng(static_cast<uint64_t>(seed) * 1000003u + epoch);
+            std::shuffle(idx.begin(), idx.end(), rng);
+        }
+        return idx;
+    }
+
+    void worker_loop() {
+        while (true) {
+            int64_t b;
+            Slot* slot;
+            {
+                std::unique_lock<std::mutex> lock(mtx);
+                if (stopping || next_claim >= num_batches) return;
+                b = next_claim++;
+                slot = &slots[b % slots.size()];
+
+                // Wait until the consumer has finished with batch b - slots
+                slot_free.wait(lock, [&] {
+                    return stopping ||
+                           (consumed > b - static_cast<int64_t>(slots.size()) && !slot->ready);
+                });
+                if (stopping) return;
+                slot->batch = b;
+            }
+
+            gather(b, *slot);
+
+            {
+                std::lock_guard<std::mutex> lock(mtx);
+                slot->ready = true;
+            }
+            slot_ready.notify_all();
+        }
+    }
+
+    void gather(int64_t b, Slot& slot) {
+        const int64_t start = b * batch_size;
+        const int rows = static_cast<int>(std::min<int64_t>(batch_size, data.size() - start));
+        const size_t feature_bytes = data.num_features() * sizeof(float);
+
+        float* features = reinterpret_cast<float*>(slot.buffer.ptr);
+        int32_t* labels = reinterpret_cast<int32_t*>(
+            slot.buffer.ptr + static_cast<size_t>(batch_size) * row_stride * sizeof(float));
+
+        for (int r = 0; r < rows; ++r) {
+            int64_t i = order[start + r];
+            std::memcpy(features + static_cast<size_t>(r) * row_stride, data.record(i),
+                        feature_bytes);
+            labels[r] = data.label(i);
+        }
+        slot.rows = rows;
+    }
+
+    void stop_workers() {
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            stopping = true;
+        }
+        slot_free.notify_all();
+        for (auto& w : workers) w.join();
+        workers.clear();
+    }
+};
@@ -0,0 +1,396 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <fstream>
+#include <iostream>
+#include <cassert>
+#include <algorithm>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "tensor.h"
+
+/*
+ * Binary record dataset
+ *
+ * File layout (little-endian):
+ *   [DatasetHeader, 64 bytes]
+ *   [record 0][record 1] ... [record N-1]
+ *
+ * A record is `num_features` floats followed by an int32 label,
+ * zero-padded to `record_stride` bytes. The stride is a multiple of
+ * 16, so every record's features start on a 16-byte boundary and a
+ * run of consecutive records is a row-major matrix with row stride
+ * record_stride / 4 floats.
+ */
+static const char DATASET_MAGIC[8] = { 'D', 'N', 'N', 'R', 'E', 'C', '0', '1' };
+static const uint32_t DATASET_VERSION = 1;
+static const uint32_t DATASET_ALIGNMENT = 16;
+
+struct DatasetHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t num_features;
+    uint64_t num_records;
+    uint32_t record_stride;   // bytes per record
+    uint32_t label_offset;    // byte offset of the label inside a record
+    uint8_t reserved[32];
+};
+static_assert(sizeof(DatasetHeader) == 64, "DatasetHeader must be 64 bytes");
+
+inline uint32_t dataset_record_stride(int num_features) {
+    uint32_t bytes = static_cast<uint32_t>(num_features + 1) * sizeof(float);
+    return (bytes + DATASET_ALIGNMENT - 1) / DATASET_ALIGNMENT * DATASET_ALIGNMENT;
+}
+
+inline DatasetHeader make_dataset_header(int num_features, uint64_t num_records) {
+    DatasetHeader h;
+    std::memset(&h, 0, sizeof(h));
+    std::memcpy(h.magic, DATASET_MAGIC, sizeof(h.magic));
+    h.version = DATASET_VERSION;
+    h.num_features = static_cast<uint32_t>(num_features);
+    h.num_records = num_records;
+    h.record_stride = dataset_record_stride(num_features);
+    h.label_offset = static_cast<uint32_t>(num_features) * sizeof(float);
+    return h;
+}
+
+inline bool check_dataset_header(const DatasetHeader& h, const std::string& path) {
+    if (std::memcmp(h.magic, DATASET_MAGIC, sizeof(h.magic)) != 0 ||
+        h.version != DATASET_VERSION) {
+        std::cerr << "ERROR: " << path << " is not a DNN record dataset" << std::endl;
+        return false;
+    }
+    // Features, then a 4-byte aligned label, inside each record
+    if (h.num_features == 0 ||
+        h.record_stride % DATASET_ALIGNMENT != 0 ||
+        h.label_offset % sizeof(int32_t) != 0 ||
+        static_cast<uint64_t>(h.num_features) * sizeof(float) > h.label_offset ||
+        static_cast<uint64_t>(h.label_offset) + sizeof(int32_t) > h.record_stride) {
+        std::cerr << "ERROR: " << path << " has a corrupt record layout" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+// The header's records fit in a file of file_size bytes (after
+// check_dataset_header: record_stride is non-zero)
+inline bool check_dataset_size(const DatasetHeader& h, uint64_t file_size, const std::string& path) {
+    if (file_size < sizeof(DatasetHeader) ||
+        h.num_records > (file_size - sizeof(DatasetHeader)) / h.record_stride) {
+        std::cerr << "ERROR: " << path << " is truncated" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+/*
+ * Non-owning view of a mini-batch
+ * features: (rows x cols), row stride `stride` floats
+ * labels  : rows entries, `label_stride` int32s apart
+ *
+ * Points straight into the mapped file (or a loader's staging
+ * buffer); valid as long as the owner is.
+ */
+struct BatchView {
+    const float* features = nullptr;
+    const int32_t* labels = nullptr;
+    int rows = 0;
+    int cols = 0;
+    int stride = 0;
+    int label_stride = 0;
+
+    float operator()(int r, int c) const {
+        return features[static_cast<size_t>(r) * stride + c];
+    }
+
+    int label(int r) const {
+        return labels[static_cast<size_t>(r) * label_stride];
+    }
+
+    // The features as a tensor view (e.g. for matmul, or rows of a
+    // Dataset::batch(start, count) sliced further)
+    TensorView view() const {
+        return TensorView(features, rows, cols, stride);
+    }
+};
+
+/*
+ * Stream of mini-batches consumed by Model::fit / Model::evaluate
+ * A view returned by next() stays valid until the following call.
+ */
+class BatchSource {
+public:
+    virtual int num_features() const = 0;
+    virtual void start_epoch(int epoch) = 0;
+    virtual bool next(BatchView& batch) = 0;   // false at end of epoch
+
+    // The epoch ended early on an error (I/O, missing shard, ...)
+    virtual bool failed() const { return false; }
+
+    virtual ~BatchSource() = default;
+};
+
+/*
+ * Read-only, memory-mapped record dataset
+ * Batches are views into the mapping: no copy, no per-sample allocation.
+ */
+class Dataset {
+public:
+    Dataset() = default;
+    Dataset(const Dataset&) = delete;
+    Dataset& operator=(const Dataset&) = delete;
+
+    ~Dataset() { close(); }
+
+    bool open(const std::string& path) {
+        close();
+
+#ifdef _WIN32
+        file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                           OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+        if (file == INVALID_HANDLE_VALUE) {
+            std::cerr << "ERROR: Cannot open " << path << std::endl;
+            return false;
+        }
+        LARGE_INTEGER size;
+        GetFileSizeEx(file, &size);
+        map_size = static_cast<size_t>(size.QuadPart);
+        if (map_size >= sizeof(DatasetHeader)) {
+            mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+            if (mapping)
+                base = static_cast<const char*>(
+                    MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+        }
+#else
+        fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            std::cerr << "ERROR: Cannot open " << path << std::endl;
+            return false;
+        }
+        struct stat st;
+        fstat(fd, &st);
+        map_size = static_cast<size_t>(st.st_size);
+        if (map_size >= sizeof(DatasetHeader)) {
+            void* p = mmap(nullptr, map_size, PROT_READ, MAP_SHARED, fd, 0);
+            if (p != MAP_FAILED) {
+                base = static_cast<const char*>(p);
+                madvise(p, map_size, MADV_SEQUENTIAL);
+            }
+        }
+#endif
+        if (!base) {
+            std::cerr << "ERROR: Cannot map " << path << std::endl;
+            close();
+            return false;
+        }
+
+        std::memcpy(&header, base, sizeof(header));
+        if (!check_dataset_header(header, path) || !check_dataset_size(header, map_size, path)) {
+            close();
+            return false;
+        }
+        return true;
+    }
+
+    void close() {
+#ifdef _WIN32
+        if (base) UnmapViewOfFile(base);
+        if (mapping) CloseHandle(mapping);
+        if (file != INVALID_HANDLE_VALUE) CloseHandle(file);
+        mapping = nullptr;
+        file = INVALID_HANDLE_VALUE;
+#else
+        if (base) munmap(const_cast<char*>(base), map_size);
+        if (fd >= 0) ::close(fd);
+        fd = -1;
+#endif
+        base = nullptr;
+        map_size = 0;
+        std::memset(&header, 0, sizeof(header));
+    }
+
+    bool is_open() const { return base != nullptr; }
+
+    int64_t size() const { return static_cast<int64_t>(header.num_records); }
+    int num_features() const { return static_cast<int>(header.num_features); }
+
+    // Row stride of the feature matrix, in floats
+    int stride() const { return static_cast<int>(header.record_stride / sizeof(float)); }
+
+    const float* record(int64_t i) const {
+        assert(i >= 0 && i < size());
+        return reinterpret_cast<const float*>(
+            base + sizeof(DatasetHeader) + static_cast<size_t>(i) * header.record_stride);
+    }
+
+    int label(int64_t i) const {
+        int32_t y;
+        std::memcpy(&y, reinterpret_cast<const char*>(record(i)) + header.label_offset,
+                    sizeof(y));
+        return y;
+    }
+
+    /*
+     * Records [start, start + count), clamped to the end of the file
+     */
+    BatchView batch(int64_t start, int count) const {
+        assert(start >= 0 && start < size());
+        BatchView v;
+        v.rows = static_cast<int>(std::min<int64_t>(count, size() - start));
+        v.cols = num_features();
+        v.stride = stride();
+        v.label_stride = stride();
+        v.features = record(start);
+        v.labels = reinterpret_cast<const int32_t*>(
+            reinterpret_cast<const char*>(v.features) + header.label_offset);
+        return v;
+    }
+
+    /*
+     * Hint the kernel to start reading records ahead of use
+     */
+    void prefetch(int64_t start, int count) const {
+#ifndef _WIN32
+        if (start >= size()) return;
+        size_t page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+        size_t begin = sizeof(DatasetHeader) + static_cast<size_t>(start) * header.record_stride;
+        size_t end = std::min(map_size,
+                              begin + static_cast<size_t>(count) * header.record_stride);
+        begin = begin / page * page;
+        madvise(const_cast<char*>(base) + begin, end - begin, MADV_WILLNEED);
+#else
+        (void)start;
+        (void)count;
+#endif
+    }
+
+private:
+    DatasetHeader header{};
+    const char* base = nullptr;
+    size_t map_size = 0;
+#ifdef _WIN32
+    HANDLE file = INVALID_HANDLE_VALUE;
+    HANDLE mapping = nullptr;
+#else
+    int fd = -1;
+#endif
+};
+
+/*
+ * In-order batches straight out of the mapping (no shuffle, no copy)
+ */
+class DatasetBatches : public BatchSource {
+public:
+    DatasetBatches(const Dataset& data, int batch_size)
+        : data(data), batch_size(batch_size) {}
+
+    int num_features() const override { return data.num_features(); }
+
+    void start_epoch(int) override { pos = 0; }
+
+    bool next(BatchView& batch) override {
+        if (pos >= data.size()) return false;
+        batch = data.batch(pos, batch_size);
+        pos += batch.rows;
+        data.prefetch(pos, batch_size);
+        return true;
+    }
+
+private:
+    const Dataset& data;
+    int batch_size;
+    int64_t pos = 0;
+};
+
+/*
+ * Streaming writer for the record format
+ * Header is rewritten with the final record count on close(). Until
+ * close() succeeds the file is incomplete: abort(), a failed close()
+ * and destruction without close() delete it, so an error path never
+ * leaves a file that readers would accept.
+ */
+class DatasetWriter {
+public:
+    DatasetWriter() = default;
+    DatasetWriter(const DatasetWriter&) = delete;
+    DatasetWriter& operator=(const DatasetWriter&) = delete;
+
+    ~DatasetWriter() { abort(); }
+
+    bool open(const std::string& path_, int num_features) {
+        abort();
+        fout.open(path_, std::ios::binary | std::ios::trunc);
+        if (!fout) {
+            std::cerr << "ERROR: Cannot create " << path_ << std::endl;
+            return false;
+        }
+        path = path_;
+        header = make_dataset_header(num_features, 0);
+        record_buf.assign(header.record_stride, 0);
+        fout.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        return true;
+    }
+
+    void append(const float* features, int label) {
+        std::memcpy(record_buf.data(), features, header.label_offset);
+        int32_t y = label;
+        std::memcpy(record_buf.data() + header.label_offset, &y, sizeof(y));
+        fout.write(record_buf.data(), header.record_stride);
+        header.num_records++;
+    }
+
+    /*
+     * Append `count` records already laid out with record_stride()
+     */
+    void append_raw(const char* records, size_t count) {
+        fout.write(records, static_cast<std::streamsize>(count * header.record_stride));
+        header.num_records += count;
+    }
+
+    uint32_t record_stride() const { return header.record_stride; }
+    uint32_t label_offset() const { return header.label_offset; }
+    uint64_t size() const { return header.num_records; }
+
+    bool close() {
+        if (!fout.is_open()) return true;
+        fout.seekp(0);
+        fout.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        fout.close();
+        if (fout.fail()) {
+            std::remove(path.c_str());
+            path.clear();
+            return false;
+        }
+        path.clear();
+        return true;
+    }
+
+    // Discard the output of an unfinished write
+    void abort() {
+        if (!fout.is_open()) return;
+        fout.close();
+        std::remove(path.c_str());
+        path.clear();
+    }
+
+private:
+    std::ofstream fout;
+    std::string path;   // file being written, until close()
+    DatasetHeader header{};
+    std::vector<char> record_buf;
+};
@@ -3,9 +3,28 @@
 #include "tensor.h"
 #include "activations.h"
 #include "optimizers.h"
+#include "mixed_precision.h"
+#include "sparse_tensor.h"
 #include <vector>
+#include <memory>
+#include <utility>
+#include <algorithm>
 #include <cassert>
 
+/*
+ * Alternate inference-time storage for a layer's W (quantized, ...)
+ * When a layer holds one, forward() computes X * W through it; the
+ * fp32 W is kept for backward() and for re-packing unless the layer
+ * is released for inference (DenseLayer::release_for_inference).
+ */
+class PackedWeights {
+public:
+    // X: (rows x input_dim), row stride ld; out: (rows x output_dim), overwritten
+    virtual void multiply(const float* X, int rows, int ld, float* out) const = 0;
+    virtual size_t bytes() const = 0;
+    virtual ~PackedWeights() = default;
+};
+
 /*
  * Fully Connected (Dense) Layer
  * Implements:
@@ -28,10 +47,37 @@ public:
 
     // Cache (for backprop)
     Tensor input_cache;
+    const float* input_ptr = nullptr;  // rows seen by the last forward
+    int input_rows = 0;
+    int input_ld = 0;                  // row stride of input_ptr (floats)
+    const SparseTensor* sparse_input = nullptr;   // instead of input_ptr, see forward(SparseTensor)
+    const BitMask* input_mask = nullptr;           // set when the masked path ran
+
+    // Inputs from a RELU layer below this density take the masked
+    // path (only rows of W for non-zero inputs); denser ones use gemm
+    // (measured crossover of the two kernels: ~0.8-0.9)
+    float sparse_input_threshold = 0.75f;
 
     // Activation function
     Activation activation;
 
+    // Optional packed W used by forward() (inference only)
+    std::unique_ptr<PackedWeights> packed;
+
+    // bf16 GEMMs for mixed-precision training (see set_bf16_compute)
+    bool bf16_compute = false;
+    std::vector<bf16_t> W_bf16;       // working copy of W
+    std::vector<bf16_t> input_bf16;   // (rows x input_dim), cached for backward
+    std::vector<bf16_t> grad_bf16;    // (rows x output_dim), backward scratch
+
+    // Optional 0/1 per W entry; sync_weights() re-applies it after each
+    // optimizer step so a sparsity pattern survives fine-tuning
+    std::vector<float> weight_mask;
+
+    // Training state (and, when packed, the fp32 W) freed, see
+    // release_for_inference()
+    bool inference_only = false;
+
     DenseLayer(int input_dim, int output_dim, ActivationType act_type = ActivationType::LINEAR)
         : W(input_dim, output_dim),
           b(output_dim, 0.0f),
@@ -45,18 +91,218 @@ public:
         b_param.grad = grad_b;
     }
 
+    // Variants (e.g. BinaryDenseLayer) override forward_into/backward/sync_weights
+    virtual ~DenseLayer() = default;
+
     /*
      * Forward pass
-     * X: (batch_size x input_dim)
+     * X: (batch_size x input_dim), a Tensor or any view; copied into
+     * input_cache for backward
+     * nz: for the output of a RELU layer, that layer's
+     * Activation::output_nonzeros() for X, or nullptr
+     *
+     * Zero inputs contribute nothing, so when nz shows X sparse
+     * enough (sparse_input_threshold) only the rows of W for non-zero
+     * inputs are accumulated; backward() then also skips them.
+     */
+    Tensor forward(const TensorView& X, const BitMask* nz = nullptr) {
+        assert(X.cols == W.rows);
+
+        input_cache.assign(X);
+
+        return forward(input_cache.data.data(), X.rows, X.cols, nz);
+    }
+
+    // As above, taking over X's storage as the input cache (for
+    // temporaries); a TensorArena temporary is copied instead, the
+    // cache outlives its scope
+    Tensor forward(Tensor&& X, const BitMask* nz = nullptr) {
+        assert(X.cols == W.rows);
+
+        if (dynamic_cast<const TensorArena*>(X.data.get_allocator().memory))
+            input_cache.assign(X);
+        else
+            input_cache.adopt(std::move(X));
+
+        return forward(input_cache.data.data(), input_cache.rows, input_cache.cols, nz);
+    }
+
+    /*
+     * Forward pass on rows owned by the caller (no copy)
+     * X: (rows x input_dim), row stride ld
+     *
+     * X (and nz, see forward(TensorView, nz)) must stay alive until
+     * backward() has run.
+     */
+    Tensor forward(const float* X, int rows, int ld, const BitMask* nz = nullptr) {
+        Tensor Y;
+        forward_into(X, rows, ld, nz, Y);
+        return Y;
+    }
+
+    /*
+     * Forward pass on a sparse input (first layer)
+     * X: (rows x input_dim) CSR; only rows of W for non-zero features
+     * are read, and backward() then yields a row-sparse dW and no dX.
+     *
+     * X must stay alive until backward() has run.
+     */
+    Tensor forward(const SparseTensor& X) {
+        Tensor Y;
+        forward_into(X, Y);
+        return Y;
+    }
+
+    /*
+     * Forward pass borrowing X: read in place (not copied) when its
+     * rows are contiguous, so X must stay alive and unchanged until
+     * backward() has run; other strides (e.g. a transposed view) are
+     * gathered into input_cache. The opt-in for inputs the caller
+     * keeps anyway (a mapped dataset batch, Model's layer outputs).
+     */
+    Tensor forward_borrowed(const TensorView& X, const BitMask* nz = nullptr) {
+        Tensor Y;
+        forward_borrowed(X, nz, Y);
+        return Y;
+    }
+
+    // As above, writing the output into Y (resized, reusing its
+    // allocation): Model keeps one Y per layer, which the next layer
+    // then borrows
+    void forward_borrowed(const TensorView& X, const BitMask* nz, Tensor& Y) {
+        assert(X.cols == W.rows);
+
+        if (X.row_major()) {
+            forward_into(X.data, X.rows, X.row_stride, nz, Y);
+            return;
+        }
+
+        input_cache.assign(X);
+        forward_into(input_cache.data.data(), X.rows, X.cols, nz, Y);
+    }
+
+    /*
+     * forward(const float*, ...) and forward(SparseTensor), writing
+     * the output into Y as above
      */
-    Tensor forward(const Tensor& X) {
+
+    virtual void forward_into(const float* X, int rows, int ld, const BitMask* nz, Tensor& Y) {
+        assert(ld >= W.rows);
+
+        sparse_input = nullptr;
+        input_ptr = X;
+        input_rows = rows;
+        input_ld = ld;
+
+        const bool masked = nz && !packed && !bf16_compute &&
+                            nz->density() < sparse_input_threshold;
+        input_mask = masked ? nz : nullptr;
+
+        Tensor out(rows, W.cols);
+        if (masked) {
+            assert(nz->rows == rows && nz->cols == W.rows);
+            gemm_masked(X, ld, *nz, W.data.data(), W.cols, out.data.data());
+        } else if (packed) {
+            packed->multiply(X, rows, ld, out.data.data());
+        } else if (bf16_compute) {
+            input_bf16.resize(static_cast<size_t>(rows) * W.rows);
+            for (int i = 0; i < rows; ++i)
+                float_to_bf16(X + static_cast<size_t>(i) * ld,
+                              &input_bf16[static_cast<size_t>(i) * W.rows], W.rows);
+            gemm_bf16(input_bf16.data(), rows, W.rows, W.rows,
+                      W_bf16.data(), W.cols, out.data.data());
+        } else {
+            gemm(X, rows, W.rows, ld, W.data.data(), W.cols, out.data.data());
+        }
+        add_bias(out, b);
+        activation.forward_into(out, Y);
+    }
+
+    virtual void forward_into(const SparseTensor& X, Tensor& Y) {
         assert(X.cols == W.rows);
 
-        input_cache = X;  // cache input for backward
+        if (packed || bf16_compute) {
+            // These paths take dense rows
+            input_cache = X.to_dense();
+            forward_into(input_cache.data.data(), X.rows, X.cols, nullptr, Y);
+            return;
+        }
 
-        Tensor out = matmul(X, W);
+        sparse_input = &X;
+        input_mask = nullptr;
+        input_ptr = nullptr;
+        input_rows = X.rows;
+        input_ld = 0;
+
+        Tensor out(X.rows, W.cols);
+        spmm(X, W.data.data(), W.cols, out.data.data());
         add_bias(out, b);
-        return activation.forward(out);
+        activation.forward_into(out, Y);
+    }
+
+    /*
+     * Whether forward_planned / backward_planned apply (fp32 W, no
+     * packed or bf16 path; variants override)
+     */
+    virtual bool plannable() const {
+        return !packed && !bf16_compute;
+    }
+
+    /*
+     * Forward pass on caller buffers (Model's memory plan, see
+     * Model::compile); nothing is allocated or cached but the mask
+     * X: (rows x input_dim), row stride ld; nz as in forward(TensorView, nz)
+     * Z: (rows x output_dim) pre-activation, overwritten
+     * Y: (rows x output_dim) output, overwritten
+     *
+     * X, nz and (for activations that read them) Z and Y must stay
+     * unchanged until backward_planned().
+     */
+    void forward_planned(const float* X, int rows, int ld, const BitMask* nz, float* Z, float* Y) {
+        assert(plannable());
+
+        sparse_input = nullptr;
+        input_ptr = X;
+        input_rows = rows;
+        input_ld = ld;
+
+        const bool masked = nz && nz->density() < sparse_input_threshold;
+        input_mask = masked ? nz : nullptr;
+
+        if (masked)
+            gemm_masked(X, ld, *nz, W.data.data(), W.cols, Z);
+        else
+            gemm(X, rows, W.rows, ld, W.data.data(), W.cols, Z);
+        add_bias(Z, rows, W.cols, b);
+        activation.forward(Z, Y, rows, W.cols);
+    }
+
+    /*
+     * Backward pass on caller buffers
+     * dOut: (rows x output_dim), overwritten with the pre-activation gradient
+     * Z, Y: as given to forward_planned()
+     * dX:   (rows x input_dim), overwritten; nullptr skips it (first layer)
+     */
+    void backward_planned(float* dOut, const float* Z, const float* Y, float* dX) {
+        assert(!inference_only && "layer was released for inference");
+        const int rows = input_rows;
+        activation.backward_inplace(dOut, Z, Y, rows, W.cols);
+
+        // dW = X^T * dOut_activated
+        if (input_mask)
+            gemm_tn_masked(input_ptr, input_ld, *input_mask, dOut, W.cols, grad_W.data.data());
+        else
+            gemm_tn(input_ptr, rows, W.rows, input_ld, dOut, W.cols, grad_W.data.data());
+
+        bias_gradient(dOut, rows);
+        sync_gradients();
+
+        // dX = dOut_activated * W^T
+        if (!dX) return;
+        if (input_mask)
+            gemm_nt_masked(dOut, W.cols, W.data.data(), *input_mask, dX);
+        else
+            gemm_nt(dOut, rows, W.cols, W.data.data(), W.rows, dX);
     }
 
     /*
@@ -66,44 +312,219 @@ public:
      * Returns:
      * dX: gradient w.r.t input (batch_size x input_dim)
      */
-    Tensor backward(const Tensor& dOut) {
+    virtual Tensor backward(const Tensor& dOut) {
+        assert(!inference_only && "layer was released for inference");
         assert(dOut.cols == W.cols);
-        assert(dOut.rows == input_cache.rows);
+        assert(dOut.rows == input_rows);
 
         // Apply activation backward
         Tensor dOut_activated = activation.backward(dOut);
 
+        if (bf16_compute)
+            return backward_bf16(dOut_activated);
+        if (sparse_input)
+            return backward_sparse(dOut_activated);
+        if (input_mask)
+            return backward_masked(dOut_activated);
+
         // dW = X^T * dOut_activated
-        Tensor X_T = transpose(input_cache);
-        grad_W = matmul(X_T, dOut_activated);
+        gemm_tn(input_ptr, input_rows, W.rows, input_ld,
+                dOut_activated.data.data(), W.cols, grad_W.data.data());
 
         // db = sum over batch
-        std::fill(grad_b.begin(), grad_b.end(), 0.0f);
-        for (int i = 0; i < dOut_activated.rows; ++i) {
-            for (int j = 0; j < dOut_activated.cols; ++j) {
-                grad_b[j] += dOut_activated(i, j);
-            }
-        }
+        bias_gradient(dOut_activated);
 
         // Sync gradients to parameters (for optimizer)
         sync_gradients();
 
         // dX = dOut_activated * W^T
-        Tensor W_T = transpose(W);
-        Tensor dX = matmul(dOut_activated, W_T);
+        Tensor dX(input_rows, W.rows);
+        gemm_nt(dOut_activated.data.data(), input_rows, W.cols, W.data.data(), W.rows, dX.data.data());
 
         return dX;
     }
 
+    /*
+     * Inference only: free the optimizer's copy of W and b, the
+     * gradients and the bf16 working copy, and, when packed weights
+     * serve forward(), the fp32 W itself (W keeps its shape), so only
+     * the storage forward() reads stays resident. The layer cannot
+     * train afterwards; packing W again needs it reloaded
+     * (load_model_weights).
+     */
+    void release_for_inference() {
+        std::vector<float>().swap(W_param.data);
+        std::vector<float>().swap(W_param.grad);
+        std::vector<float>().swap(b_param.data);
+        std::vector<float>().swap(b_param.grad);
+        std::vector<float>().swap(grad_b);
+        grad_W.clear();
+        std::vector<bf16_t>().swap(W_bf16);
+        if (packed) {
+            W.data.clear();
+            W.data.shrink_to_fit();
+        }
+        inference_only = true;
+    }
+
+    // W is resident (not freed by release_for_inference), so it can
+    // be packed
+    bool has_fp32_weights() const {
+        return W.data.size() == static_cast<size_t>(W.rows) * W.cols;
+    }
+
+    // Bytes held for the weights: fp32 W and b, the optimizer's
+    // copies, gradients, the bf16 working copy and packed weights
+    size_t weight_bytes() const {
+        return (W.data.size() + b.size() + W_param.data.size() + W_param.grad.size() +
+                b_param.data.size() + b_param.grad.size() + grad_W.data.size() + grad_b.size()) *
+                   sizeof(float) +
+               W_bf16.size() * sizeof(bf16_t) + (packed ? packed->bytes() : 0);
+    }
+
+    // Bytes held for backward (input copy and activation caches)
+    size_t cache_bytes() const {
+        return input_cache.data.size() * sizeof(float) + input_bf16.size() * sizeof(bf16_t) +
+               activation.cache_bytes();
+    }
+
+    /*
+     * Free the caches backward() needs, for recomputation later
+     * (see Model::set_checkpointing); forward() must run again before
+     * backward(). keep_input leaves input_cache to re-run from.
+     */
+    void release_cache(bool keep_input = false) {
+        if (!keep_input) input_cache.clear();
+        std::vector<bf16_t>().swap(input_bf16);
+        activation.release();
+    }
+
+    /*
+     * Whether backward() reads only the bf16 copy of the last input
+     * (input_bf16), so the fp32 input may be freed after forward
+     */
+    virtual bool bf16_input_only() const {
+        return bf16_compute && !packed;
+    }
+
+    /*
+     * Mixed precision: GEMM operands in bf16, fp32 accumulation.
+     * The bf16 copy of W tracks W through sync_weights().
+     */
+    void set_bf16_compute(bool enabled) {
+        bf16_compute = enabled;
+        if (enabled) {
+            W_bf16.resize(W.data.size());
+            float_to_bf16(W.data.data(), W_bf16.data(), W.data.size());
+        } else {
+            W_bf16.clear();
+            input_bf16.clear();
+            grad_bf16.clear();
+        }
+    }
+
     // Sync gradients from grad_W/grad_b to W_param/b_param
     void sync_gradients() {
-        W_param.grad = grad_W.data;
+        W_param.grad.assign(grad_W.data.begin(), grad_W.data.end());
+        W_param.rows.clear();
         b_param.grad = grad_b;
     }
 
     // Sync weights from W_param/b_param back to W/b
-    void sync_weights() {
+    virtual void sync_weights() {
+        assert(!inference_only && "layer was released for inference");
+        if (!weight_mask.empty())
+            for (size_t i = 0; i < W_param.data.size(); ++i)
+                W_param.data[i] *= weight_mask[i];
         W.data = W_param.data;
         b = b_param.data;
+        if (bf16_compute)
+            float_to_bf16(W.data.data(), W_bf16.data(), W.data.size());
+    }
+
+protected:
+    void bias_gradient(const Tensor& dOut_activated) {
+        bias_gradient(dOut_activated.data.data(), dOut_activated.rows);
+    }
+
+    // dOut_activated: (rows x output_dim)
+    void bias_gradient(const float* dOut_activated, int rows) {
+        const int N = static_cast<int>(grad_b.size());
+        std::fill(grad_b.begin(), grad_b.end(), 0.0f);
+        for (int i = 0; i < rows; ++i) {
+            const float* d = dOut_activated + static_cast<size_t>(i) * N;
+            for (int j = 0; j < N; ++j) {
+                grad_b[j] += d[j];
+            }
+        }
+    }
+
+    /*
+     * dW = X^T * dOut_activated for a sparse X: only rows of features
+     * present in the batch are non-zero, and only those are cleared,
+     * written and synced (W_param.rows lists them for the optimizer).
+     * The input is the model input, so no dX is returned.
+     */
+    Tensor backward_sparse(const Tensor& dOut_activated) {
+        const int N = W.cols;
+        if (W_param.rows.empty()) {
+            std::fill(grad_W.data.begin(), grad_W.data.end(), 0.0f);
+            W_param.grad.assign(grad_W.data.size(), 0.0f);
+        } else {
+            for (int r : W_param.rows) {
+                std::fill_n(grad_W.data.begin() + static_cast<size_t>(r) * N, N, 0.0f);
+                std::fill_n(W_param.grad.begin() + static_cast<size_t>(r) * N, N, 0.0f);
+            }
+        }
+
+        spmm_tn_accumulate(*sparse_input, dOut_activated.data.data(), N, grad_W.data.data());
+        bias_gradient(dOut_activated);
+
+        W_param.rows = nonzero_columns(*sparse_input);
+        W_param.row_size = N;
+        for (int r : W_param.rows)
+            std::copy_n(grad_W.data.begin() + static_cast<size_t>(r) * N, N,
+                        W_param.grad.begin() + static_cast<size_t>(r) * N);
+        b_param.grad = grad_b;
+        return Tensor();
+    }
+
+    /*
+     * Backward after the masked forward: dW rows and dX entries for
+     * zero inputs are skipped. Those dX entries would be multiplied by
+     * the RELU derivative (0 there), so they are left at 0.
+     */
+    Tensor backward_masked(const Tensor& dOut_activated) {
+        const BitMask& nz = *input_mask;
+
+        // dW = X^T * dOut_activated
+        gemm_tn_masked(input_ptr, input_ld, nz, dOut_activated.data.data(), W.cols,
+                       grad_W.data.data());
+
+        bias_gradient(dOut_activated);
+        sync_gradients();
+
+        // dX = dOut_activated * W^T at the non-zero inputs
+        Tensor dX(input_rows, W.rows);
+        gemm_nt_masked(dOut_activated.data.data(), W.cols, W.data.data(), nz, dX.data.data());
+        return dX;
+    }
+
+    Tensor backward_bf16(const Tensor& dOut_activated) {
+        const int rows = dOut_activated.rows;
+        grad_bf16.resize(dOut_activated.data.size());
+        float_to_bf16(dOut_activated.data.data(), grad_bf16.data(), grad_bf16.size());
+
+        // dW = X^T * dOut_activated
+        gemm_tn_bf16(input_bf16.data(), rows, W.rows, W.rows,
+                     grad_bf16.data(), W.cols, grad_W.data.data());
+
+        bias_gradient(dOut_activated);
+        sync_gradients();
+
+        // dX = dOut_activated * W^T
+        Tensor dX(rows, W.rows);
+        gemm_nt_bf16(grad_bf16.data(), rows, W.cols, W_bf16.data(), W.rows, dX.data.data());
+        return dX;
     }
 };
@@ -0,0 +1,140 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <cstddef>
+
+#if defined(__F16C__) || (defined(__AVX512BF16__) && defined(__AVX512VL__))
+#include <immintrin.h>
+#endif
+
+#if defined(__AVX512BF16__) && defined(__AVX512VL__)
+#define DNN_BF16_DOT 1   // vdpbf16ps: bf16 pair dot products into fp32
+#endif
+
+/*
+ * 16-bit float formats
+ *
+ *   fp16: IEEE binary16 (1 + 5 + 10 bits), F16C converts in hardware
+ *   bf16: top half of an fp32 (1 + 8 + 7 bits), same range as fp32
+ *
+ * fp32 -> 16-bit rounds to nearest even. bf16 conversion flushes
+ * denormals to zero, as vcvtneps2bf16 does, so the scalar and
+ * AVX-512 BF16 paths give the same bits.
+ */
+typedef uint16_t half_t;
+typedef uint16_t bf16_t;
+
+inline uint32_t float_bits(float f) {
+    uint32_t u;
+    std::memcpy(&u, &f, sizeof(u));
+    return u;
+}
+
+inline float bits_float(uint32_t u) {
+    float f;
+    std::memcpy(&f, &u, sizeof(f));
+    return f;
+}
+
+inline half_t float_to_half(float f) {
+    uint32_t u = float_bits(f);
+    uint32_t sign = (u >> 16) & 0x8000u;
+    uint32_t exp = (u >> 23) & 0xFFu;
+    uint32_t mant = u & 0x7FFFFFu;
+
+    if (exp == 0xFF)                                        // inf / nan
+        return static_cast<half_t>(sign | 0x7C00u | (mant ? 0x200u | (mant >> 13) : 0));
+
+    int e = static_cast<int>(exp) - 127 + 15;
+    if (e >= 0x1F) return static_cast<half_t>(sign | 0x7C00u);   // overflow -> inf
+
+    if (e <= 0) {                                           // half denormal or zero
+        if (e < -10) return static_cast<half_t>(sign);
+        mant |= 0x800000u;
+        int shift = 14 - e;
+        uint32_t h = mant >> shift;
+        uint32_t rest = mant & ((1u << shift) - 1);
+        uint32_t halfway = 1u << (shift - 1);
+        if (rest > halfway || (rest == halfway && (h & 1))) h++;
+        return static_cast<half_t>(sign | h);
+    }
+
+    uint32_t h = (static_cast<uint32_t>(e) << 10) | (mant >> 13);
+    uint32_t rest = mant & 0x1FFFu;
+    if (rest > 0x1000u || (rest == 0x1000u && (h & 1))) h++;   // may carry into exp
+    return static_cast<half_t>(sign | h);
+}
+
+inline float half_to_float(half_t h) {
+    uint32_t sign = static_cast<uint32_t>(h & 0x8000u) << 16;
+    uint32_t exp = (h >> 10) & 0x1Fu;
+    uint32_t mant = h & 0x3FFu;
+
+    if (exp == 0x1F) return bits_float(sign | 0x7F800000u | (mant << 13));
+    if (exp == 0) {
+        if (mant == 0) return bits_float(sign);
+        // denormal: renormalize
+        int e = -1;
+        do {
+            mant <<= 1;
+            e++;
+        } while (!(mant & 0x400u));
+        return bits_float(sign | (static_cast<uint32_t>(127 - 15 - e) << 23) | ((mant & 0x3FFu) << 13));
+    }
+    return bits_float(sign | ((exp + 127 - 15) << 23) | (mant << 13));
+}
+
+inline bf16_t float_to_bf16(float f) {
+    uint32_t u = float_bits(f);
+    if ((u & 0x7F800000u) == 0x7F800000u && (u & 0x7FFFFFu))   // nan: keep it quiet
+        return static_cast<bf16_t>((u >> 16) | 0x40u);
+    if ((u & 0x7F800000u) == 0)                               // zero / denormal
+        return static_cast<bf16_t>((u >> 16) & 0x8000u);
+    u += 0x7FFFu + ((u >> 16) & 1u);
+    return static_cast<bf16_t>(u >> 16);
+}
+
+inline float bf16_to_float(bf16_t h) {
+    return bits_float(static_cast<uint32_t>(h) << 16);
+}
+
+/*
+ * Bulk conversions (n elements)
+ */
+inline void float_to_half(const float* src, half_t* dst, size_t n) {
+    size_t i = 0;
+#ifdef __F16C__
+    for (; i + 8 <= n; i += 8) {
+        __m128i h = _mm256_cvtps_ph(_mm256_loadu_ps(src + i), _MM_FROUND_TO_NEAREST_INT);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), h);
+    }
+#endif
+    for (; i < n; ++i) dst[i] = float_to_half(src[i]);
+}
+
+inline void half_to_float(const half_t* src, float* dst, size_t n) {
+    size_t i = 0;
+#ifdef __F16C__
+    for (; i + 8 <= n; i += 8) {
+        __m128i h = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+        _mm256_storeu_ps(dst + i, _mm256_cvtph_ps(h));
+    }
+#endif
+    for (; i < n; ++i) dst[i] = half_to_float(src[i]);
+}
+
+inline void float_to_bf16(const float* src, bf16_t* dst, size_t n) {
+    size_t i = 0;
+#ifdef DNN_BF16_DOT
+    for (; i + 8 <= n; i += 8) {
+        __m128bh h = _mm256_cvtneps_pbh(_mm256_loadu_ps(src + i));
+        std::memcpy(dst + i, &h, sizeof(h));
+    }
+#endif
+    for (; i < n; ++i) dst[i] = float_to_bf16(src[i]);
+}
+
+inline void bf16_to_float(const bf16_t* src, float* dst, size_t n) {
+    for (size_t i = 0; i < n; ++i) dst[i] = bf16_to_float(src[i]);
+}
@@ -0,0 +1,125 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <algorithm>
+#include <cassert>
+
+#include "tensor.h"
+#include "dense_layer.h"
+#include "model.h"
+
+/*
+ * Incremental inference session
+ *
+ * For a stream of single inputs that differ in only a few features,
+ * the session keeps layer 0's pre-activation accumulator
+ *   z = x * W + b
+ * and on each new input applies only the changed features:
+ *   z += (x'_k - x_k) * W(k, :)   for every k with x'_k != x_k
+ * so the first layer costs O(changed x output_dim) instead of a full
+ * GEMV; the (cheaper) layers after it run as usual.
+ *
+ * Rounding error accumulates in z, so it is recomputed from scratch
+ * every refresh_interval incremental updates, and whenever more than
+ * dense_fraction of the features changed (a full GEMV is cheaper).
+ *
+ * Layer 0 is read as a plain fp32 DenseLayer (W, b, activation; not
+ * its packed weights). The session drives the model's layers, so it
+ * must not run concurrently with other use of the same Model.
+ */
+class IncrementalSession {
+public:
+    int refresh_interval;
+    float dense_fraction;
+
+    // Counters since construction / reset()
+    int64_t incremental_updates = 0;
+    int64_t full_recomputes = 0;
+
+    IncrementalSession(Model& model_, int refresh_interval_ = 1000, float dense_fraction_ = 0.25f)
+        : refresh_interval(refresh_interval_),
+          dense_fraction(dense_fraction_),
+          model(model_),
+          first(model_.layer(0)),
+          x(first.W.rows, 0.0f),
+          z(1, first.W.cols) {
+        assert(model.num_layers() >= 1);
+        assert(first.has_fp32_weights());
+    }
+
+    /*
+     * Output for one sample x_new (input_dim floats)
+     */
+    Tensor predict(const float* x_new) {
+        TensorArenaScope scope;
+        const int K = first.W.rows, N = first.W.cols;
+
+        changed.clear();
+        if (valid) {
+            for (int k = 0; k < K; ++k)
+                if (x_new[k] != x[k]) changed.push_back(k);
+        }
+
+        if (!valid || since_refresh >= refresh_interval ||
+            changed.size() > dense_fraction * K) {
+            recompute(x_new);
+        } else {
+            for (int k : changed) {
+                const float dx = x_new[k] - x[k];
+                const float* w = first.W.data.data() + static_cast<size_t>(k) * N;
+                for (int j = 0; j < N; ++j) z.data[j] += dx * w[j];
+                x[k] = x_new[k];
+            }
+            since_refresh++;
+            incremental_updates++;
+        }
+
+        // Each layer borrows the previous one's output, kept in outputs
+        while (outputs.size() < static_cast<size_t>(model.num_layers()))
+            outputs.emplace_back(0, 0, TensorAllocator<float>::heap());
+        first.activation.forward_into(z, outputs[0]);
+        for (int l = 1; l < model.num_layers(); ++l)
+            model.layer(l).forward_borrowed(outputs[l - 1], model.layer(l - 1).activation.output_nonzeros(),
+                                            outputs[l]);
+        return heap_copy(outputs.back());
+    }
+
+    // x_new: (1 x input_dim)
+    Tensor predict(const Tensor& x_new) {
+        assert(x_new.rows == 1 && x_new.cols == first.W.rows);
+        return predict(x_new.data.data());
+    }
+
+    // Features that changed in the last predict() (empty after a full recompute)
+    const std::vector<int>& last_changed() const { return changed; }
+
+    /*
+     * Forget the cached input; call after the model's weights change
+     */
+    void reset() {
+        valid = false;
+        incremental_updates = 0;
+        full_recomputes = 0;
+    }
+
+private:
+    Model& model;
+    DenseLayer& first;
+    std::vector<float> x;     // input the accumulator corresponds to
+    Tensor z;                 // (1 x output_dim) x * W + b
+    std::vector<Tensor> outputs;   // each layer's output, on the heap
+    std::vector<int> changed;
+    bool valid = false;
+    int since_refresh = 0;
+
+    void recompute(const float* x_new) {
+        std::copy(x_new, x_new + first.W.rows, x.begin());
+        gemm(x.data(), 1, first.W.rows, first.W.rows, first.W.data.data(), first.W.cols, z.data.data());
+        add_bias(z, first.b);
+        changed.clear();
+        valid = true;
+        since_refresh = 0;
+        full_recomputes++;
+    }
+};
@@ -31,7 +31,7 @@ public:
     /*
      * Forward loss computation
      */
-    float forward(const Tensor& y_pred,
+    float forward(const TensorView& y_pred,
                   const std::vector<int>& y_true_sparse,
                   const Tensor* y_true_dense = nullptr) const {
         switch (type) {
@@ -53,28 +53,41 @@ public:
     /*
      * Backward gradient computation
      */
-    Tensor backward(const Tensor& y_pred,
+    Tensor backward(const TensorView& y_pred,
                     const std::vector<int>& y_true_sparse,
                     const Tensor* y_true_dense = nullptr) const {
+        Tensor grad;
+        backward_into(y_pred, y_true_sparse, grad, y_true_dense);
+        return grad;
+    }
+
+    // As backward(), into grad (resized, reusing its allocation)
+    void backward_into(const TensorView& y_pred,
+                       const std::vector<int>& y_true_sparse,
+                       Tensor& grad,
+                       const Tensor* y_true_dense = nullptr) const {
         switch (type) {
             case LossType::MEAN_SQUARED_ERROR:
-                return mse_backward(y_pred, *y_true_dense);
+                mse_backward(y_pred, *y_true_dense, grad);
+                break;
 
             case LossType::BINARY_CROSS_ENTROPY:
-                return binary_cross_entropy_backward(y_pred, *y_true_dense);
+                binary_cross_entropy_backward(y_pred, *y_true_dense, grad);
+                break;
 
             case LossType::CATEGORICAL_CROSS_ENTROPY:
-                return categorical_cross_entropy_backward(y_pred, *y_true_dense);
+                categorical_cross_entropy_backward(y_pred, *y_true_dense, grad);
+                break;
 
             case LossType::SPARSE_CATEGORICAL_CROSS_ENTROPY:
-                return sparse_categorical_cross_entropy_backward(y_pred, y_true_sparse);
+                sparse_categorical_cross_entropy_backward(y_pred, y_true_sparse, grad);
+                break;
         }
-        return Tensor();
     }
 
 private:
     // ---------- MSE ----------
-    float mse(const Tensor& y_pred, const Tensor& y_true) const {
+    float mse(const TensorView& y_pred, const TensorView& y_true) const {
         float loss = 0.0f;
         for (int i = 0; i < y_pred.rows; ++i)
             for (int j = 0; j < y_pred.cols; ++j)
@@ -82,18 +95,17 @@ private:
         return loss / (y_pred.rows * y_pred.cols);
     }
 
-    Tensor mse_backward(const Tensor& y_pred, const Tensor& y_true) const {
-        Tensor grad(y_pred.rows, y_pred.cols);
+    void mse_backward(const TensorView& y_pred, const TensorView& y_true, Tensor& grad) const {
+        grad.resize(y_pred.rows, y_pred.cols);
         float scale = 2.0f / (y_pred.rows * y_pred.cols);
         for (int i = 0; i < grad.rows; ++i)
             for (int j = 0; j < grad.cols; ++j)
                 grad(i, j) = scale * (y_pred(i, j) - y_true(i, j));
-        return grad;
     }
 
     // ---------- Binary Cross-Entropy ----------
-    float binary_cross_entropy(const Tensor& y_pred,
-                               const Tensor& y_true) const {
+    float binary_cross_entropy(const TensorView& y_pred,
+                               const TensorView& y_true) const {
         float loss = 0.0f;
         for (int i = 0; i < y_pred.rows; ++i) {
             float p = std::clamp(y_pred(i, 0), eps, 1.0f - eps);
@@ -103,20 +115,19 @@ private:
         return loss / y_pred.rows;
     }
 
-    Tensor binary_cross_entropy_backward(const Tensor& y_pred,
-                                         const Tensor& y_true) const {
-        Tensor grad(y_pred.rows, 1);
+    void binary_cross_entropy_backward(const TensorView& y_pred,
+                                       const TensorView& y_true, Tensor& grad) const {
+        grad.resize(y_pred.rows, 1);
         for (int i = 0; i < y_pred.rows; ++i) {
             float p = std::clamp(y_pred(i, 0), eps, 1.0f - eps);
             float y = y_true(i, 0);
             grad(i, 0) = (p - y) / (p * (1.0f - p));
         }
-        return grad;
     }
 
     // ---------- Categorical Cross-Entropy ----------
-    float categorical_cross_entropy(const Tensor& y_pred,
-                                    const Tensor& y_true) const {
+    float categorical_cross_entropy(const TensorView& y_pred,
+                                    const TensorView& y_true) const {
         float loss = 0.0f;
         for (int i = 0; i < y_pred.rows; ++i)
             for (int j = 0; j < y_pred.cols; ++j)
@@ -125,17 +136,16 @@ private:
         return loss / y_pred.rows;
     }
 
-    Tensor categorical_cross_entropy_backward(const Tensor& y_pred,
-                                              const Tensor& y_true) const {
-        Tensor grad(y_pred.rows, y_pred.cols);
+    void categorical_cross_entropy_backward(const TensorView& y_pred,
+                                            const TensorView& y_true, Tensor& grad) const {
+        grad.resize(y_pred.rows, y_pred.cols);
         for (int i = 0; i < grad.rows; ++i)
             for (int j = 0; j < grad.cols; ++j)
                 grad(i, j) = (y_pred(i, j) - y_true(i, j)) / y_pred.rows;
-        return grad;
     }
 
     // ---------- Sparse Categorical Cross-Entropy ----------
-    float sparse_categorical_cross_entropy(const Tensor& y_pred,
+    float sparse_categorical_cross_entropy(const TensorView& y_pred,
                                            const std::vector<int>& y_true) const {
         float loss = 0.0f;
         for (int i = 0; i < y_pred.rows; ++i) {
@@ -145,11 +155,12 @@ private:
         return loss / y_pred.rows;
     }
 
-    Tensor sparse_categorical_cross_entropy_backward(
-        const Tensor& y_pred,
-        const std::vector<int>& y_true) const {
+    void sparse_categorical_cross_entropy_backward(
+        const TensorView& y_pred,
+        const std::vector<int>& y_true,
+        Tensor& grad) const {
 
-        Tensor grad(y_pred.rows, y_pred.cols);
+        grad.resize(y_pred.rows, y_pred.cols);
         for (int i = 0; i < y_pred.rows; ++i) {
             for (int j = 0; j < y_pred.cols; ++j)
                 grad(i, j) = y_pred(i, j);
@@ -160,6 +171,5 @@ private:
         for (float& v : grad.data)
             v *= inv_batch;
 
-        return grad;
     }
 };
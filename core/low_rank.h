@@ -0,0 +1,232 @@
+#pragma once
+
+#include <vector>
+#include <cmath>
+#include <random>
+#include <numeric>
+#include <algorithm>
+#include <cassert>
+
+#include "tensor.h"
+#include "dense_layer.h"
+#include "model.h"
+
+/*
+ * Low-rank factorization of dense layers
+ *
+ * W (K x N) ~= A (K x r) * B (r x N), from a truncated SVD
+ * W ~= U S V^T with A = U sqrt(S), B = sqrt(S) V^T (balanced, so
+ * both factors train at similar scales). The layer then runs as two
+ * thinner GEMMs: (K + N) * r multiply-adds per row instead of K * N.
+ *
+ * The SVD is randomized (Halko, Martinsson & Tropp):
+ *   Y = (W W^T)^q W Omega,  Omega Gaussian N x (r + p)
+ *   Q = orth(Y)
+ *   SVD of the small Q^T W by one-sided Jacobi
+ * computed in double precision.
+ */
+struct LowRankFactors {
+    Tensor A;                        // (K x r)
+    Tensor B;                        // (r x N)
+    std::vector<float> singular;     // top r singular values, descending
+};
+
+namespace low_rank_detail {
+
+// Row-major double matrix
+struct Mat {
+    int rows = 0;
+    int cols = 0;
+    std::vector<double> v;
+    Mat(int r, int c) : rows(r), cols(c), v(static_cast<size_t>(r) * c, 0.0) {}
+    double& operator()(int r, int c) { return v[static_cast<size_t>(r) * cols + c]; }
+    double operator()(int r, int c) const { return v[static_cast<size_t>(r) * cols + c]; }
+};
+
+// C = op(X) * Y, op = transpose when tx
+inline Mat mul(const Mat& X, const Mat& Y, bool tx = false) {
+    const int m = tx ? X.cols : X.rows;
+    const int k = tx ? X.rows : X.cols;
+    assert(k == Y.rows);
+    Mat C(m, Y.cols);
+    for (int p = 0; p < k; ++p)
+        for (int i = 0; i < m; ++i) {
+            const double x = tx ? X(p, i) : X(i, p);
+            if (x == 0.0) continue;
+            for (int j = 0; j < Y.cols; ++j) C(i, j) += x * Y(p, j);
+        }
+    return C;
+}
+
+// Orthonormalize the columns of Y in place (modified Gram-Schmidt)
+inline void orthonormalize(Mat& Y) {
+    for (int j = 0; j < Y.cols; ++j) {
+        for (int i = 0; i < j; ++i) {
+            double d = 0.0;
+            for (int r = 0; r < Y.rows; ++r) d += Y(r, i) * Y(r, j);
+            for (int r = 0; r < Y.rows; ++r) Y(r, j) -= d * Y(r, i);
+        }
+        double n = 0.0;
+        for (int r = 0; r < Y.rows; ++r) n += Y(r, j) * Y(r, j);
+        n = std::sqrt(n);
+        for (int r = 0; r < Y.rows; ++r) Y(r, j) = n > 1e-300 ? Y(r, j) / n : 0.0;
+    }
+}
+
+/*
+ * One-sided Jacobi SVD of M (n x l): rotates columns until pairwise
+ * orthogonal, M J = U S. Returns S; M becomes U S, J accumulates the
+ * rotations (l x l).
+ */
+inline std::vector<double> jacobi_svd(Mat& M, Mat& J) {
+    const int l = M.cols;
+    for (int i = 0; i < l; ++i) J(i, i) = 1.0;
+
+    for (int sweep = 0; sweep < 60; ++sweep) {
+        bool rotated = false;
+        for (int p = 0; p < l - 1; ++p) {
+            for (int q = p + 1; q < l; ++q) {
+                double alpha = 0.0, beta = 0.0, gamma = 0.0;
+                for (int r = 0; r < M.rows; ++r) {
+                    alpha += M(r, p) * M(r, p);
+                    beta += M(r, q) * M(r, q);
+                    gamma += M(r, p) * M(r, q);
+                }
+                if (std::fabs(gamma) <= 1e-15 * std::sqrt(alpha * beta)) continue;
+                rotated = true;
+
+                double zeta = (beta - alpha) / (2.0 * gamma);
+                double t = (zeta >= 0 ? 1.0 : -1.0) / (std::fabs(zeta) + std::sqrt(1.0 + zeta * zeta));
+                double c = 1.0 / std::sqrt(1.0 + t * t);
+                double s = c * t;
+                for (int r = 0; r < M.rows; ++r) {
+                    double mp = M(r, p), mq = M(r, q);
+                    M(r, p) = c * mp - s * mq;
+                    M(r, q) = s * mp + c * mq;
+                }
+                for (int r = 0; r < l; ++r) {
+                    double jp = J(r, p), jq = J(r, q);
+                    J(r, p) = c * jp - s * jq;
+                    J(r, q) = s * jp + c * jq;
+                }
+            }
+        }
+        if (!rotated) break;
+    }
+
+    std::vector<double> S(l);
+    for (int j = 0; j < l; ++j) {
+        double n = 0.0;
+        for (int r = 0; r < M.rows; ++r) n += M(r, j) * M(r, j);
+        S[j] = std::sqrt(n);
+    }
+    return S;
+}
+
+} // namespace low_rank_detail
+
+/*
+ * Rank-`rank` factors of W (rank <= min(K, N))
+ */
+inline LowRankFactors randomized_svd(const Tensor& W, int rank,
+                                     int oversample = 8, int power_iters = 4,
+                                     unsigned seed = 0) {
+    using namespace low_rank_detail;
+    const int K = W.rows, N = W.cols;
+    assert(rank >= 1 && rank <= std::min(K, N));
+    const int l = std::min(rank + oversample, std::min(K, N));
+
+    Mat Wd(K, N);
+    for (size_t i = 0; i < W.data.size(); ++i) Wd.v[i] = W.data[i];
+
+    std::mt19937 rng(seed);
+    std::normal_distribution<double> normal(0.0, 1.0);
+    Mat Omega(N, l);
+    for (auto& x : Omega.v) x = normal(rng);
+
+    // Range finder with power iterations (re-orthonormalized each time)
+    Mat Y = mul(Wd, Omega);
+    orthonormalize(Y);
+    for (int it = 0; it < power_iters; ++it) {
+        Mat Z = mul(Wd, Y, true);   // W^T Y (N x l)
+        orthonormalize(Z);
+        Y = mul(Wd, Z);
+        orthonormalize(Y);
+    }
+
+    // Small problem: (Q^T W)^T = W^T Q (N x l) = U_t S J^T
+    // so Q^T W = J S U_t^T and W ~= (Q J) S U_t^T
+    Mat M = mul(Wd, Y, true);
+    Mat J(l, l);
+    std::vector<double> S = jacobi_svd(M, J);
+
+    std::vector<int> order(l);
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [&](int a, int b) { return S[a] > S[b]; });
+
+    Mat QJ = mul(Y, J);   // (K x l) left singular vectors
+    LowRankFactors f;
+    f.A = Tensor(K, rank);
+    f.B = Tensor(rank, N);
+    f.singular.resize(rank);
+    for (int c = 0; c < rank; ++c) {
+        const int j = order[c];
+        const double s = S[j];
+        const double root = std::sqrt(s);
+        f.singular[c] = static_cast<float>(s);
+        for (int r = 0; r < K; ++r)
+            f.A(r, c) = static_cast<float>(QJ(r, j) * root);
+        // Right singular vector = column j of M / s
+        for (int n = 0; n < N; ++n)
+            f.B(c, n) = s > 0.0 ? static_cast<float>(M(n, j) / s * root) : 0.0f;
+    }
+    return f;
+}
+
+/*
+ * Build `out` (empty Model) from `src`, replacing layer l with a
+ * LINEAR rank-ranks[l] layer followed by one with the original bias
+ * and activation; ranks[l] <= 0 keeps layer l dense. Layers of `out`
+ * are owned by it.
+ */
+inline void factorize_model(Model& src, const std::vector<int>& ranks, Model& out,
+                            unsigned seed = 0) {
+    assert(out.num_layers() == 0);
+    assert(static_cast<int>(ranks.size()) == src.num_layers());
+
+    for (int l = 0; l < src.num_layers(); ++l) {
+        const DenseLayer& s = src.layer(l);
+        const int rank = ranks[l];
+
+        if (rank <= 0) {
+            DenseLayer& d = out.add(s.W.rows, s.W.cols, s.activation.type);
+            d.W.data = s.W.data;
+            d.b = s.b;
+            d.W_param.data = d.W.data;
+            d.b_param.data = d.b;
+            continue;
+        }
+
+        LowRankFactors f = randomized_svd(s.W, rank, 8, 4, seed + l);
+        DenseLayer& first = out.add(s.W.rows, rank, ActivationType::LINEAR);
+        DenseLayer& second = out.add(rank, s.W.cols, s.activation.type);
+        first.W.data = f.A.data;
+        second.W.data = f.B.data;
+        second.b = s.b;
+        first.W_param.data = first.W.data;
+        first.b_param.data = first.b;
+        second.W_param.data = second.W.data;
+        second.b_param.data = second.b;
+    }
+}
+
+// ||W - A B||_F / ||W||_F
+inline float relative_error(const Tensor& W, const LowRankFactors& f) {
+    Tensor AB = matmul(f.A, f.B);
+    double diff = 0.0, norm = 0.0;
+    for (size_t i = 0; i < W.data.size(); ++i) {
+        diff += (W.data[i] - AB.data[i]) * (W.data[i] - AB.data[i]);
+        norm += W.data[i] * W.data[i];
+    }
+    return static_cast<float>(std::sqrt(diff / std::max(norm, 1e-30)));
+}
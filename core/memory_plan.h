@@ -0,0 +1,112 @@
+#pragma once
+
+#include <vector>
+#include <cstddef>
+#include <utility>
+#include <algorithm>
+#include <cassert>
+
+#include "tensor.h"
+
+/*
+ * Static memory plan
+ *
+ * Buffers with a known size and lifetime (the first and last step, in
+ * some fixed schedule, that touch them) are packed into one arena by
+ * interval coloring: largest buffer first, each placed at the lowest
+ * offset where it does not overlap any placed buffer whose lifetime
+ * intersects its own. Buffers that are never live together share
+ * memory, and the arena size (peak) is known before anything runs.
+ *
+ * Offsets are multiples of ALIGN floats (64 bytes) from a 64-byte
+ * aligned heap block.
+ */
+class MemoryPlan {
+public:
+    static constexpr size_t ALIGN = 16;
+
+    struct Buffer {
+        size_t size;      // floats
+        int first;        // lifetime, inclusive
+        int last;
+        size_t offset;    // floats into the arena, set by finalize()
+    };
+
+    // Register a buffer; returns its id for at()
+    int add(size_t size, int first, int last) {
+        assert(first <= last);
+        buffers.push_back({ size, first, last, 0 });
+        return static_cast<int>(buffers.size()) - 1;
+    }
+
+    /*
+     * Assign offsets and allocate the arena
+     */
+    void finalize() {
+        std::vector<int> order(buffers.size());
+        for (size_t i = 0; i < order.size(); ++i) order[i] = static_cast<int>(i);
+        std::stable_sort(order.begin(), order.end(), [&](int a, int b) {
+            return buffers[a].size > buffers[b].size;
+        });
+
+        size_t total = 0;
+        std::vector<int> placed;
+        std::vector<std::pair<size_t, size_t>> busy;   // [begin, end) of live neighbours
+        for (int id : order) {
+            Buffer& buf = buffers[id];
+
+            busy.clear();
+            for (int other : placed) {
+                const Buffer& o = buffers[other];
+                if (o.first <= buf.last && buf.first <= o.last)
+                    busy.push_back({ o.offset, o.offset + o.size });
+            }
+            std::sort(busy.begin(), busy.end());
+
+            // Lowest gap that fits
+            size_t offset = 0;
+            for (const auto& range : busy) {
+                if (offset + buf.size <= range.first) break;
+                offset = std::max(offset, round_up(range.second));
+            }
+
+            buf.offset = offset;
+            total = std::max(total, offset + buf.size);
+            placed.push_back(id);
+        }
+
+        arena.assign(round_up(total), 0.0f);
+    }
+
+    float* at(int id) {
+        return arena.data() + buffers[id].offset;
+    }
+
+    // Arena size
+    size_t peak_bytes() const {
+        return arena.size() * sizeof(float);
+    }
+
+    // What the buffers would take without sharing
+    size_t unshared_bytes() const {
+        size_t total = 0;
+        for (const Buffer& buf : buffers) total += round_up(buf.size);
+        return total * sizeof(float);
+    }
+
+    size_t num_buffers() const {
+        return buffers.size();
+    }
+
+    bool empty() const {
+        return buffers.empty();
+    }
+
+private:
+    std::vector<Buffer> buffers;
+    TensorData arena{ TensorAllocator<float>::heap() };
+
+    static size_t round_up(size_t n) {
+        return (n + ALIGN - 1) / ALIGN * ALIGN;
+    }
+};
@@ -0,0 +1,150 @@
+#pragma once
+
+#include <vector>
+#include <cmath>
+#include <cstdint>
+#include <algorithm>
+
+#include "half.h"
+
+#if defined(__AVX2__) && defined(__FMA__)
+#include <immintrin.h>
+#define DNN_MIXED_AVX2 1
+#endif
+
+/*
+ * Mixed-precision training support
+ *
+ * GEMM operands (weights, cached layer inputs, activation gradients)
+ * are bf16; products accumulate in fp32 and results are fp32. The
+ * optimizer keeps updating the fp32 master copy in each Parameter,
+ * and the bf16 working copy is refreshed from it after every step.
+ */
+
+#ifdef DNN_MIXED_AVX2
+// 8 bf16 -> 8 fp32 (bf16 is the top half of an fp32)
+inline __m256 load_bf16x8(const bf16_t* p) {
+    __m256i w = _mm256_cvtepu16_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p)));
+    return _mm256_castsi256_ps(_mm256_slli_epi32(w, 16));
+}
+
+inline float hsum(__m256 v) {
+    __m128 s = _mm_add_ps(_mm256_castps256_ps128(v), _mm256_extractf128_ps(v, 1));
+    s = _mm_add_ps(s, _mm_movehl_ps(s, s));
+    s = _mm_add_ss(s, _mm_movehdup_ps(s));
+    return _mm_cvtss_f32(s);
+}
+#endif
+
+// y[0..n) += a * x[0..n)
+inline void axpy_bf16(float a, const bf16_t* x, float* y, int n) {
+    int j = 0;
+#ifdef DNN_MIXED_AVX2
+    const __m256 av = _mm256_set1_ps(a);
+    for (; j + 8 <= n; j += 8)
+        _mm256_storeu_ps(y + j, _mm256_fmadd_ps(av, load_bf16x8(x + j), _mm256_loadu_ps(y + j)));
+#endif
+    for (; j < n; ++j) y[j] += a * bf16_to_float(x[j]);
+}
+
+inline float dot_bf16(const bf16_t* x, const bf16_t* y, int n) {
+    int j = 0;
+    float sum = 0.0f;
+#if defined(DNN_BF16_DOT)
+    __m256 acc = _mm256_setzero_ps();
+    for (; j + 16 <= n; j += 16) {
+        __m256bh xv = (__m256bh)_mm256_loadu_si256(reinterpret_cast<const __m256i*>(x + j));
+        __m256bh yv = (__m256bh)_mm256_loadu_si256(reinterpret_cast<const __m256i*>(y + j));
+        acc = _mm256_dpbf16_ps(acc, xv, yv);
+    }
+    sum = hsum(acc);
+#elif defined(DNN_MIXED_AVX2)
+    __m256 acc = _mm256_setzero_ps();
+    for (; j + 8 <= n; j += 8)
+        acc = _mm256_fmadd_ps(load_bf16x8(x + j), load_bf16x8(y + j), acc);
+    sum = hsum(acc);
+#endif
+    for (; j < n; ++j) sum += bf16_to_float(x[j]) * bf16_to_float(y[j]);
+    return sum;
+}
+
+/*
+ * bf16 GEMMs with fp32 output (same shapes as gemm / gemm_tn)
+ *   gemm_bf16   : C (m x n) = A (m x k, stride lda) * B (k x n)
+ *   gemm_tn_bf16: C (k x n) = A^T * B, A (m x k, stride lda), B (m x n)
+ *   gemm_nt_bf16: C (m x k) = A (m x n) * B^T, B (k x n)
+ */
+inline void gemm_bf16(const bf16_t* A, int m, int k, int lda,
+                      const bf16_t* B, int n, float* C) {
+    for (int i = 0; i < m; ++i) {
+        float* c_row = C + static_cast<size_t>(i) * n;
+        std::fill(c_row, c_row + n, 0.0f);
+        const bf16_t* a_row = A + static_cast<size_t>(i) * lda;
+        for (int p = 0; p < k; ++p)
+            axpy_bf16(bf16_to_float(a_row[p]), B + static_cast<size_t>(p) * n, c_row, n);
+    }
+}
+
+inline void gemm_tn_bf16(const bf16_t* A, int m, int k, int lda,
+                         const bf16_t* B, int n, float* C) {
+    std::fill(C, C + static_cast<size_t>(k) * n, 0.0f);
+    for (int i = 0; i < m; ++i) {
+        const bf16_t* a_row = A + static_cast<size_t>(i) * lda;
+        const bf16_t* b_row = B + static_cast<size_t>(i) * n;
+        for (int p = 0; p < k; ++p)
+            axpy_bf16(bf16_to_float(a_row[p]), b_row, C + static_cast<size_t>(p) * n, n);
+    }
+}
+
+inline void gemm_nt_bf16(const bf16_t* A, int m, int n,
+                         const bf16_t* B, int k, float* C) {
+    for (int i = 0; i < m; ++i) {
+        const bf16_t* a_row = A + static_cast<size_t>(i) * n;
+        float* c_row = C + static_cast<size_t>(i) * k;
+        for (int p = 0; p < k; ++p)
+            c_row[p] = dot_bf16(a_row, B + static_cast<size_t>(p) * n, n);
+    }
+}
+
+/*
+ * Dynamic loss scaling
+ *
+ * The loss gradient is multiplied by `scale` before backward and the
+ * parameter gradients are divided by it before the optimizer step.
+ * A step whose gradients contain inf/nan is skipped and the scale
+ * halved; after `growth_interval` clean steps in a row it doubles.
+ */
+struct LossScaler {
+    float scale = 65536.0f;
+    float growth_factor = 2.0f;
+    float backoff_factor = 0.5f;
+    int growth_interval = 1000;
+    float max_scale = 16777216.0f;   // 2^24
+
+    int good_steps = 0;
+    int64_t skipped_steps = 0;
+
+    LossScaler() = default;
+    explicit LossScaler(float initial_scale) : scale(initial_scale) {}
+
+    void update(bool overflow) {
+        if (overflow) {
+            scale = std::max(scale * backoff_factor, 1.0f);
+            good_steps = 0;
+            skipped_steps++;
+        } else if (++good_steps >= growth_interval) {
+            scale = std::min(scale * growth_factor, max_scale);
+            good_steps = 0;
+        }
+    }
+};
+
+// Multiply g by inv_scale; false if any entry is inf/nan
+inline bool unscale_gradients(std::vector<float>& g, float inv_scale) {
+    bool finite = true;
+    for (float& v : g) {
+        v *= inv_scale;
+        finite &= std::isfinite(v);
+    }
+    return finite;
+}
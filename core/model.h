@@ -1,5 +1,8 @@
 #pragma once
 #include <vector>
+#include <memory>
+#include <algorithm>
+#include <cmath>
 #include <iostream>
 #include <cassert>
 
@@ -7,37 +10,288 @@
 #include "dense_layer.h"
 #include "loss_functions.h"
 #include "optimizers.h"
-
+#include "dataset.h"
+#include "mixed_precision.h"
+#include "memory_plan.h"
 
 
 class Model {
 private:
     std::vector<DenseLayer*> layers;
+    std::vector<std::unique_ptr<DenseLayer>> owned_layers;   // from add(dims)
     Loss* loss_fn = nullptr;
     Optimizer* optimizer = nullptr;
 
+    bool mixed_precision = false;
+    LossScaler loss_scaler;
+
+    bool checkpointing = false;
+    int checkpoint_segment = 0;      // layers per segment, 0 = ~sqrt(depth)
+    size_t peak_cache = 0;           // bytes, see peak_cache_bytes()
+
+    // Training buffers planned by compile(loss, opt, max_batch_size)
+    struct PlannedLayer {
+        int Z = -1;     // pre-activation
+        int Y = -1;     // output (the last layer's is planned_output)
+        int dY = -1;    // gradient w.r.t. Y (the last layer's is planned_grad)
+        int in = 0;     // the layer's W shape when planned
+        int out = 0;
+    };
+    MemoryPlan plan;
+    int plan_batch = 0;
+    std::vector<PlannedLayer> planned;
+    Tensor planned_output;   // Loss takes Tensors: these two are reserved
+    Tensor planned_grad;     // once at compile() and reused
+
+    // Each layer's output from the last unplanned forward, on the heap
+    // and reused across calls; layer i + 1 reads outputs[i] in place,
+    // in forward and again in backward (fp32 layers)
+    std::vector<Tensor> outputs;
+
     /* -------- INTERNAL ENGINE (HIDDEN FROM USER) -------- */
 
-    Tensor forward_internal(const Tensor& input) {
-        Tensor x = input;
-        for (auto* layer : layers) {
-            x = layer->forward(x);
+    // The input (a Tensor, or a batch in a mapped file / staging
+    // buffer) is read in place by the first layer
+    const Tensor& forward_internal(const TensorView& input) {
+        assert(!layers.empty() && "Model has no layers");
+        reserve_outputs();
+        layers[0]->forward_borrowed(input, nullptr, outputs[0]);
+        release_for_recompute(0);
+        release_fp32_input(0);
+        for (size_t i = 1; i < layers.size(); ++i) {
+            forward_layer(i);
         }
-        return x;
+        return outputs.back();
+    }
+
+    // First layer gathers only the rows of W for non-zero features
+    const Tensor& forward_internal(const SparseTensor& input) {
+        assert(!layers.empty() && "Model has no layers");
+        reserve_outputs();
+        layers[0]->forward_into(input, outputs[0]);
+        release_for_recompute(0);
+        release_fp32_input(0);
+        for (size_t i = 1; i < layers.size(); ++i) {
+            forward_layer(i);
+        }
+        return outputs.back();
+    }
+
+    // Layer i on layer i-1's output, skipping its zeros after a RELU
+    void forward_layer(size_t i) {
+        layers[i]->forward_borrowed(outputs[i - 1], layers[i - 1]->activation.output_nonzeros(), outputs[i]);
+        release_for_recompute(i);
+        release_fp32_input(i);
+    }
+
+    // Mixed precision: a bf16 layer's backward reads only its bf16
+    // copy of the input, so the fp32 rows (outputs[i - 1], or a
+    // gathered input_cache) are freed instead of held until backward.
+    // Checkpointing re-runs segments from the fp32 inputs it keeps.
+    void release_fp32_input(size_t i) {
+        if (!mixed_precision || checkpointing || !layers[i]->bf16_input_only()) return;
+        layers[i]->input_cache.clear();
+        if (i > 0) outputs[i - 1].clear();
+    }
+
+    // Heap storage even when first called inside a TensorArenaScope
+    void reserve_outputs() {
+        while (outputs.size() < layers.size())
+            outputs.emplace_back(0, 0, TensorAllocator<float>::heap());
+    }
+
+    /* -------- GRADIENT CHECKPOINTING (see set_checkpointing) -------- */
+
+    int segment_layers() const {
+        if (checkpoint_segment > 0) return checkpoint_segment;
+        return std::max(1, static_cast<int>(std::ceil(std::sqrt(static_cast<double>(layers.size())))));
+    }
+
+    // After layer i's forward: drop what backward will recompute. The
+    // first layer of each segment keeps its input; the last segment
+    // keeps everything, its backward runs first.
+    void release_for_recompute(size_t i) {
+        if (!checkpointing) return;
+        const size_t seg = segment_layers();
+        if (i >= (layers.size() - 1) / seg * seg) return;
+        const bool keep_input = i % seg == 0;
+        layers[i]->release_cache(keep_input);
+        if (!keep_input) outputs[i - 1].clear();
+    }
+
+    // Re-run layers [start, end) from layer start's kept input,
+    // restoring the outputs and caches their backward needs
+    void recompute(int start, int end) {
+        DenseLayer& first = *layers[start];
+        const BitMask* nz = start > 0 ? layers[start - 1]->activation.output_nonzeros() : nullptr;
+        if (first.sparse_input)
+            first.forward_into(*first.sparse_input, outputs[start]);
+        else
+            first.forward_into(first.input_ptr, first.input_rows, first.input_ld, nz, outputs[start]);
+        for (int i = start + 1; i < end; ++i)
+            layers[i]->forward_borrowed(outputs[i - 1], layers[i - 1]->activation.output_nonzeros(), outputs[i]);
+        outputs[end - 1].clear();   // layer end's backward has run
+    }
+
+    // Free the caches of layers [start, end) and their inputs after
+    // their backward
+    void release_segment(int start, int end) {
+        for (int i = start; i < end; ++i) layers[i]->release_cache();
+        for (int i = std::max(start, 1); i < end; ++i) outputs[i - 1].clear();
+    }
+
+    void note_cache_bytes() {
+        peak_cache = std::max(peak_cache, cache_bytes());
     }
 
     void backward_internal(const Tensor& grad_output) {
+        note_cache_bytes();
         Tensor grad = grad_output;
-        for (int i = static_cast<int>(layers.size()) - 1; i >= 0; --i) {
-            grad = layers[i]->backward(grad);
+        if (!checkpointing) {
+            for (int i = static_cast<int>(layers.size()) - 1; i >= 0; --i) {
+                grad = layers[i]->backward(grad);
+            }
+            return;
+        }
+
+        // Segment by segment from the top: recompute, backward, free
+        const int L = static_cast<int>(layers.size());
+        const int seg = segment_layers();
+        for (int end = L; end > 0;) {
+            const int start = (end - 1) / seg * seg;
+            if (end < L) {
+                recompute(start, end);
+                note_cache_bytes();
+            }
+            for (int i = end - 1; i >= start; --i) {
+                grad = layers[i]->backward(grad);
+            }
+            release_segment(start, end);
+            end = start;
+        }
+    }
+
+    /* -------- MEMORY PLAN (see compile) -------- */
+
+    /*
+     * Schedule of one training step: layer i's forward is step i, the
+     * loss step L, layer i's backward step 2L - i. Each buffer lives
+     * from the step that writes it to the last step that reads it:
+     *   Z_i   forward i, until backward i if the activation reads it
+     *   Y_i   forward i, until backward i + 1 (its input there), or
+     *         backward i if the activation reads it
+     *   dY_i  backward i + 1 (as its dX), until backward i (which
+     *         turns it into the pre-activation gradient in place)
+     */
+    void plan_memory(int max_batch) {
+        assert(!layers.empty() && "Model has no layers");
+        const int L = static_cast<int>(layers.size());
+        plan = MemoryPlan();
+        plan_batch = max_batch;
+        planned.assign(L, PlannedLayer());
+
+        for (int i = 0; i < L; ++i) {
+            const size_t n = static_cast<size_t>(max_batch) * layers[i]->W.cols;
+            const Activation& act = layers[i]->activation;
+            planned[i].in = layers[i]->W.rows;
+            planned[i].out = layers[i]->W.cols;
+            planned[i].Z = plan.add(n, i, act.reads_input() ? 2 * L - i : i);
+            if (i + 1 < L) {
+                planned[i].Y = plan.add(n, i, act.reads_output() ? 2 * L - i : 2 * L - i - 1);
+                planned[i].dY = plan.add(n, 2 * L - i - 1, 2 * L - i);
+            }
+        }
+        plan.finalize();
+
+        planned_output.resize(max_batch, layers.back()->W.cols);
+        planned_grad.resize(max_batch, layers.back()->W.cols);
+    }
+
+    void clear_plan() {
+        plan = MemoryPlan();
+        plan_batch = 0;
+        planned.clear();
+        planned_output = Tensor();
+        planned_grad = Tensor();
+    }
+
+    bool use_plan(int rows) const {
+        if (plan.empty() || rows > plan_batch || mixed_precision || checkpointing) return false;
+        if (planned.size() != layers.size()) return false;
+        for (size_t i = 0; i < layers.size(); ++i) {
+            const DenseLayer& layer = *layers[i];
+            if (!layer.plannable()) return false;
+            if (layer.W.rows != planned[i].in || layer.W.cols != planned[i].out) return false;
+        }
+        return true;
+    }
+
+    const Tensor& forward_planned(const float* X, int rows, int ld) {
+        const int L = static_cast<int>(layers.size());
+        assert(ld >= layers[0]->W.rows);
+        planned_output.resize(rows, layers.back()->W.cols);
+
+        for (int i = 0; i < L; ++i) {
+            float* Y = i + 1 < L ? plan.at(planned[i].Y) : planned_output.data.data();
+            const BitMask* nz = i > 0 ? layers[i - 1]->activation.output_nonzeros() : nullptr;
+            layers[i]->forward_planned(X, rows, ld, nz, plan.at(planned[i].Z), Y);
+            X = Y;
+            ld = layers[i]->W.cols;
+        }
+        return planned_output;
+    }
+
+    // From planned_grad (filled by the loss) down to the first layer
+    void backward_planned() {
+        const int L = static_cast<int>(layers.size());
+        float* grad = planned_grad.data.data();
+        for (int i = L - 1; i >= 0; --i) {
+            const float* Y = i + 1 < L ? plan.at(planned[i].Y) : planned_output.data.data();
+            float* dX = i > 0 ? plan.at(planned[i - 1].dY) : nullptr;
+            layers[i]->backward_planned(grad, plan.at(planned[i].Z), Y, dX);
+            grad = dX;
         }
     }
 
     void optimizer_step() {
-        // Note: This is a simplified version. For full optimizer support,
-        // DenseLayer would need to expose Parameter structs.
-        // For now, this is a placeholder that does nothing.
-        // The actual weight updates should be handled in the backward pass.
+        for (auto* layer : layers) {
+            optimizer->step(layer->W_param);
+            optimizer->step(layer->b_param);
+            layer->sync_weights();
+        }
+    }
+
+    // Backward + update; in mixed precision the loss is scaled and a
+    // step with inf/nan gradients is skipped
+    void train_step(Tensor& grad) {
+        if (!mixed_precision) {
+            backward_internal(grad);
+            optimizer_step();
+            return;
+        }
+
+        for (auto& g : grad.data) g *= loss_scaler.scale;
+        backward_internal(grad);
+
+        const float inv_scale = 1.0f / loss_scaler.scale;
+        bool finite = true;
+        for (auto* layer : layers) {
+            finite &= unscale_gradients(layer->W_param.grad, inv_scale);
+            finite &= unscale_gradients(layer->b_param.grad, inv_scale);
+        }
+        if (finite) optimizer_step();
+        loss_scaler.update(!finite);
+    }
+
+    // Per-sample mean of total over n samples (0 for an empty dataset)
+    static float per_sample(float total, int64_t n) {
+        return n > 0 ? total / static_cast<float>(n) : 0.0f;
+    }
+
+    void print_loss_scale() const {
+        if (mixed_precision)
+            std::cout << " | Loss scale: " << loss_scaler.scale
+                      << " | Skipped steps: " << loss_scaler.skipped_steps;
     }
 
 public:
@@ -45,11 +299,105 @@ public:
 
     void add(DenseLayer& layer) {
         layers.push_back(&layer);
+        if (mixed_precision) layer.set_bf16_compute(true);
+    }
+
+    // Layer created and owned by the model (for models built at runtime)
+    DenseLayer& add(int input_dim, int output_dim,
+                    ActivationType act = ActivationType::LINEAR) {
+        owned_layers.emplace_back(new DenseLayer(input_dim, output_dim, act));
+        add(*owned_layers.back());
+        return *owned_layers.back();
     }
 
-    void compile(Loss& loss, Optimizer& opt) {
+    /*
+     * max_batch_size > 0 also plans fit()'s training buffers: every
+     * layer's pre-activation, output and gradient for batches of up to
+     * that many rows gets a fixed offset in one arena (memory_plan()),
+     * sized for the peak of what is live at once. Steps on the plan
+     * make no allocations (after the optimizer's first step). Mixed
+     * precision, checkpointing, packed or variant layers, layers
+     * reshaped since the plan and larger batches fall back to the
+     * unplanned path. Recompiling with max_batch_size = 0 drops the
+     * plan.
+     */
+    void compile(Loss& loss, Optimizer& opt, int max_batch_size = 0) {
         loss_fn = &loss;
         optimizer = &opt;
+        if (max_batch_size > 0)
+            plan_memory(max_batch_size);
+        else
+            clear_plan();
+    }
+
+    /*
+     * Opt-in mixed precision for fit(): bf16 GEMMs with fp32
+     * accumulation, fp32 master weights, dynamic loss scaling. Each
+     * layer's input is cached for backward in bf16 only (the fp32
+     * copy is freed after the layer's forward, see
+     * release_fp32_input); activation caches are unchanged (a 1-bit
+     * mask for RELU, fp32 for the others).
+     */
+    void set_mixed_precision(bool enabled, float initial_loss_scale = 65536.0f) {
+        mixed_precision = enabled;
+        peak_cache = 0;
+        loss_scaler = LossScaler(initial_loss_scale);
+        for (auto* layer : layers)
+            layer->set_bf16_compute(enabled);
+    }
+
+    const LossScaler& loss_scale() const {
+        return loss_scaler;
+    }
+
+    /*
+     * Gradient checkpointing for fit(): layers are grouped into
+     * segments of segment_layers (0: ceil(sqrt(depth))). Forward keeps
+     * only each segment's input; backward re-runs a segment's forward
+     * just before its backward. Cached activations drop from ~depth to
+     * ~2 sqrt(depth) layers' worth, for about one extra forward per
+     * step. Gradients are unchanged.
+     */
+    void set_checkpointing(bool enabled, int segment_layers = 0) {
+        checkpointing = enabled;
+        checkpoint_segment = segment_layers;
+        peak_cache = 0;
+    }
+
+    // Bytes held for backward: the layers' caches and the outputs
+    // layers read as their input
+    size_t cache_bytes() const {
+        size_t total = 0;
+        for (auto* layer : layers) total += layer->cache_bytes();
+        for (size_t i = 0; i + 1 < outputs.size(); ++i)
+            total += outputs[i].data.size() * sizeof(float);
+        return total;
+    }
+
+    /*
+     * Inference only: each layer keeps just what forward() reads (see
+     * DenseLayer::release_for_inference); with packed weights that
+     * drops the fp32 W too. The model cannot train afterwards.
+     */
+    void release_for_inference() {
+        for (auto* layer : layers) layer->release_for_inference();
+    }
+
+    // Bytes held for the layers' weights (DenseLayer::weight_bytes)
+    size_t weight_bytes() const {
+        size_t total = 0;
+        for (auto* layer : layers) total += layer->weight_bytes();
+        return total;
+    }
+
+    // Largest cache_bytes() seen during backward since set_checkpointing()
+    // or set_mixed_precision()
+    size_t peak_cache_bytes() const {
+        return peak_cache;
+    }
+
+    const MemoryPlan& memory_plan() const {
+        return plan;
     }
 
     /* -------- TRAINING (TensorFlow: model.fit) -------- */
@@ -65,34 +413,150 @@ public:
             float epoch_loss = 0.0f;
             int correct = 0;
 
+            std::vector<int> y_vec(1);
             for (size_t i = 0; i < X.size(); ++i) {
+                TensorArenaScope scope;   // this step's temporaries
                 // Forward
-                Tensor output = forward_internal(X[i]);
+                const bool planned_step = use_plan(X[i].rows);
+                const Tensor& output = planned_step
+                    ? forward_planned(X[i].data.data(), X[i].rows, X[i].cols)
+                    : forward_internal(X[i]);
 
                 // Loss
-                std::vector<int> y_vec = {y[i]};
+                y_vec[0] = y[i];
                 float loss = loss_fn->forward(output, y_vec);
                 epoch_loss += loss;
 
                 // Accuracy
                 if (argmax(output) == y[i]) correct++;
 
-                // Backward
-                Tensor grad = loss_fn->backward(output, y_vec);
-                backward_internal(grad);
+                // Backward + update
+                if (planned_step) {
+                    loss_fn->backward_into(output, y_vec, planned_grad);
+                    backward_planned();
+                    optimizer_step();
+                } else {
+                    Tensor grad = loss_fn->backward(output, y_vec);
+                    train_step(grad);
+                }
+            }
+
+            std::cout << "Epoch " << epoch + 1
+                      << " | Loss: " << per_sample(epoch_loss, X.size())
+                      << " | Accuracy: "
+                      << per_sample(correct, X.size());
+            print_loss_scale();
+            std::cout << std::endl;
+        }
+    }
+
+    /*
+     * Mini-batch training over a batch stream
+     * Each batch is a view (mapped file / loader staging buffer),
+     * fed to the first layer as-is.
+     */
+    void fit(BatchSource& data, int epochs) {
+
+        assert(loss_fn && optimizer && "Model must be compiled before training");
+        assert(data.num_features() == layers.front()->W.rows);
+
+        std::vector<int> y_vec;
+        BatchView batch;
 
-                // Update
-                optimizer_step();
+        for (int epoch = 0; epoch < epochs; ++epoch) {
+            float epoch_loss = 0.0f;
+            int64_t correct = 0;
+            int64_t seen = 0;
+
+            data.start_epoch(epoch);
+            while (data.next(batch)) {
+                TensorArenaScope scope;   // this step's temporaries
+                y_vec.resize(batch.rows);
+                for (int r = 0; r < batch.rows; ++r)
+                    y_vec[r] = batch.label(r);
+
+                const bool planned_step = use_plan(batch.rows);
+                const Tensor& output = planned_step
+                    ? forward_planned(batch.features, batch.rows, batch.stride)
+                    : forward_internal(batch.view());
+
+                // Loss is a per-batch mean; weight it back to a per-sample sum
+                epoch_loss += loss_fn->forward(output, y_vec) * batch.rows;
+                seen += batch.rows;
+
+                for (int r = 0; r < batch.rows; ++r)
+                    if (argmax_row(output, r) == y_vec[r]) correct++;
+
+                if (planned_step) {
+                    loss_fn->backward_into(output, y_vec, planned_grad);
+                    backward_planned();
+                    optimizer_step();
+                } else {
+                    Tensor grad = loss_fn->backward(output, y_vec);
+                    train_step(grad);
+                }
+            }
+            if (data.failed()) {
+                std::cerr << "ERROR: Batch source failed in epoch " << epoch + 1
+                          << " after " << seen << " samples" << std::endl;
+                return;
             }
 
             std::cout << "Epoch " << epoch + 1
-                      << " | Loss: " << epoch_loss / X.size()
+                      << " | Loss: " << per_sample(epoch_loss, seen)
                       << " | Accuracy: "
-                      << static_cast<float>(correct) / X.size()
-                      << std::endl;
+                      << per_sample(correct, seen);
+            print_loss_scale();
+            std::cout << std::endl;
         }
     }
 
+    /*
+     * Mini-batch training on sparse inputs (rows of X, labels y)
+     * The first layer's dW is row-sparse (features seen in the batch).
+     */
+    void fit(const SparseTensor& X, const std::vector<int>& y,
+             int epochs, int batch_size = 32) {
+
+        assert(loss_fn && optimizer && "Model must be compiled before training");
+        assert(X.cols == layers.front()->W.rows);
+        assert(static_cast<int>(y.size()) == X.rows);
+
+        for (int epoch = 0; epoch < epochs; ++epoch) {
+            float epoch_loss = 0.0f;
+            int64_t correct = 0;
+
+            for (int start = 0; start < X.rows; start += batch_size) {
+                TensorArenaScope scope;   // this step's temporaries
+                const int rows = std::min(batch_size, X.rows - start);
+                SparseTensor batch = X.slice_rows(start, rows);
+                std::vector<int> y_vec(y.begin() + start, y.begin() + start + rows);
+
+                const Tensor& output = forward_internal(batch);
+
+                epoch_loss += loss_fn->forward(output, y_vec) * rows;
+
+                for (int r = 0; r < rows; ++r)
+                    if (argmax_row(output, r) == y_vec[r]) correct++;
+
+                Tensor grad = loss_fn->backward(output, y_vec);
+                train_step(grad);
+            }
+
+            std::cout << "Epoch " << epoch + 1
+                      << " | Loss: " << per_sample(epoch_loss, X.rows)
+                      << " | Accuracy: "
+                      << per_sample(correct, X.rows);
+            print_loss_scale();
+            std::cout << std::endl;
+        }
+    }
+
+    void fit(const Dataset& data, int epochs, int batch_size = 32) {
+        DatasetBatches batches(data, batch_size);
+        fit(batches, epochs);
+    }
+
     /* -------- EVALUATION (TensorFlow: model.evaluate) -------- */
 
     float evaluate(const std::vector<Tensor>& X,
@@ -104,25 +568,95 @@ public:
         int correct = 0;
 
         for (size_t i = 0; i < X.size(); ++i) {
-            Tensor output = forward_internal(X[i]);
+            TensorArenaScope scope;   // this batch's temporaries
+            const Tensor& output = forward_internal(X[i]);
             std::vector<int> y_vec = {y[i]};
             total_loss += loss_fn->forward(output, y_vec);
 
             if (argmax(output) == y[i]) correct++;
         }
 
-        float accuracy = static_cast<float>(correct) / X.size();
+        float accuracy = per_sample(correct, X.size());
 
-        std::cout << "Evaluation Loss: " << total_loss / X.size() << std::endl;
+        std::cout << "Evaluation Loss: " << per_sample(total_loss, X.size()) << std::endl;
         std::cout << "Evaluation Accuracy: " << accuracy << std::endl;
 
         return accuracy;
     }
 
+    float evaluate(BatchSource& data) {
+
+        assert(loss_fn && "Loss function not set");
+        assert(data.num_features() == layers.front()->W.rows);
+
+        float total_loss = 0.0f;
+        int64_t correct = 0;
+        int64_t seen = 0;
+        std::vector<int> y_vec;
+        BatchView batch;
+
+        data.start_epoch(0);
+        while (data.next(batch)) {
+            TensorArenaScope scope;   // this batch's temporaries
+            y_vec.resize(batch.rows);
+            for (int r = 0; r < batch.rows; ++r)
+                y_vec[r] = batch.label(r);
+
+            const Tensor& output = forward_internal(batch.view());
+            // Loss is a per-batch mean; weight it back to a per-sample sum
+            total_loss += loss_fn->forward(output, y_vec) * batch.rows;
+            seen += batch.rows;
+
+            for (int r = 0; r < batch.rows; ++r)
+                if (argmax_row(output, r) == y_vec[r]) correct++;
+        }
+
+        if (data.failed()) {
+            std::cerr << "ERROR: Batch source failed after " << seen << " samples" << std::endl;
+            return 0.0f;
+        }
+
+        float accuracy = per_sample(correct, seen);
+
+        std::cout << "Evaluation Loss: " << per_sample(total_loss, seen) << std::endl;
+        std::cout << "Evaluation Accuracy: " << accuracy << std::endl;
+
+        return accuracy;
+    }
+
+    float evaluate(const Dataset& data, int batch_size = 256) {
+        DatasetBatches batches(data, batch_size);
+        return evaluate(batches);
+    }
+
     /* -------- INFERENCE (TensorFlow: model.predict) -------- */
 
-    Tensor predict(const Tensor& input) {
-        return forward_internal(input);
+    // Temporaries come from the thread's arena; the result is copied
+    // out of the model's output buffer (reused by the next call)
+    Tensor predict(const TensorView& input) {
+        TensorArenaScope scope;
+        return heap_copy(forward_internal(input));
+    }
+
+    Tensor predict(const BatchView& batch) {
+        TensorArenaScope scope;
+        return heap_copy(forward_internal(batch.view()));
+    }
+
+    Tensor predict(const SparseTensor& input) {
+        TensorArenaScope scope;
+        return heap_copy(forward_internal(input));
+    }
+
+    /* -------- LAYER ACCESS (calibration / compression tools) -------- */
+
+    int num_layers() const {
+        return static_cast<int>(layers.size());
+    }
+
+    DenseLayer& layer(int i) {
+        assert(i >= 0 && i < num_layers());
+        return *layers[i];
     }
 
 
@@ -0,0 +1,209 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <fstream>
+#include <sstream>
+#include <iostream>
+#include <cstdlib>
+
+#include "dense_layer.h"
+#include "model.h"
+#include "weight_quantization.h"
+#include "half.h"
+
+/*
+ * On-disk element format of a .bin weight file (raw, no header)
+ */
+enum class BinFormat {
+    FP32,
+    FP16,
+    BF16
+};
+
+inline bool parse_bin_format(const std::string& name, BinFormat& format) {
+    if (name == "fp32") format = BinFormat::FP32;
+    else if (name == "fp16") format = BinFormat::FP16;
+    else if (name == "bf16") format = BinFormat::BF16;
+    else return false;
+    return true;
+}
+
+// File suffix for `format`: ".bin", ".fp16.bin", ".bf16.bin"
+inline std::string bin_extension(BinFormat format) {
+    switch (format) {
+        case BinFormat::FP16: return ".fp16.bin";
+        case BinFormat::BF16: return ".bf16.bin";
+        default:              return ".bin";
+    }
+}
+
+/* -------------------------------------------------
+   Binary weight loader
+------------------------------------------------- */
+template <typename Alloc>
+inline void load_bin(const std::string& path, std::vector<float, Alloc>& buffer,
+                     BinFormat format = BinFormat::FP32) {
+    std::ifstream fin(path, std::ios::binary);
+    if (!fin) {
+        std::cerr << "ERROR: Cannot open " << path << std::endl;
+        std::exit(1);
+    }
+    if (format == BinFormat::FP32) {
+        fin.read(reinterpret_cast<char*>(buffer.data()),
+                 buffer.size() * sizeof(float));
+        return;
+    }
+    std::vector<uint16_t> half(buffer.size());
+    fin.read(reinterpret_cast<char*>(half.data()), half.size() * sizeof(uint16_t));
+    if (format == BinFormat::FP16)
+        half_to_float(half.data(), buffer.data(), buffer.size());
+    else
+        bf16_to_float(half.data(), buffer.data(), buffer.size());
+}
+
+/* -------------------------------------------------
+   Binary weight saver
+------------------------------------------------- */
+template <typename Alloc>
+inline void save_bin(const std::string& path, const std::vector<float, Alloc>& buffer,
+                     BinFormat format = BinFormat::FP32) {
+    std::ofstream fout(path, std::ios::binary);
+    if (format == BinFormat::FP32) {
+        fout.write(reinterpret_cast<const char*>(buffer.data()),
+                   buffer.size() * sizeof(float));
+        return;
+    }
+    std::vector<uint16_t> half(buffer.size());
+    if (format == BinFormat::FP16)
+        float_to_half(buffer.data(), half.data(), buffer.size());
+    else
+        float_to_bf16(buffer.data(), half.data(), buffer.size());
+    fout.write(reinterpret_cast<const char*>(half.data()), half.size() * sizeof(uint16_t));
+}
+
+/* -------------------------------------------------
+   Load dense{i}_W.bin / dense{i}_b.bin (i = 1..N) from `dir`
+   into the model's layers and sync their parameters.
+   `storage` picks the inference weight format (fp16/bf16 and
+   weight-only int8/int4 need no calibration data). inference_only
+   then keeps only what forward() reads (Model::release_for_inference):
+   with non-fp32 storage the fp32 W is freed, so the packed weights
+   replace it in memory instead of adding to it.
+------------------------------------------------- */
+inline void load_model_weights(Model& model, const std::string& dir,
+                               WeightStorage storage = WeightStorage::FP32,
+                               bool inference_only = false) {
+    for (int i = 0; i < model.num_layers(); ++i) {
+        DenseLayer& layer = model.layer(i);
+        std::string prefix = dir + "/dense" + std::to_string(i + 1);
+        load_bin(prefix + "_W.bin", layer.W.data);
+        load_bin(prefix + "_b.bin", layer.b);
+        layer.W_param.data = layer.W.data;
+        layer.b_param.data = layer.b;
+    }
+    set_weight_storage(model, storage);
+    if (inference_only) model.release_for_inference();
+}
+
+/* -------------------------------------------------
+   architecture.txt: the layer widths on the first line, input
+   first ("80 192 96 48 10"), and optionally each layer's
+   activation on the second ("relu relu relu softmax"). Without
+   the second line hidden layers are RELU and the last SOFTMAX, as
+   in the reference model.
+------------------------------------------------- */
+inline const char* activation_name(ActivationType type) {
+    switch (type) {
+        case ActivationType::STEP:       return "step";
+        case ActivationType::LINEAR:     return "linear";
+        case ActivationType::RELU:       return "relu";
+        case ActivationType::LEAKY_RELU: return "leaky_relu";
+        case ActivationType::PRELU:      return "prelu";
+        case ActivationType::SIGMOID:    return "sigmoid";
+        case ActivationType::TANH:       return "tanh";
+        case ActivationType::ELU:        return "elu";
+        case ActivationType::SELU:       return "selu";
+        case ActivationType::GELU:       return "gelu";
+        case ActivationType::SWISH:      return "swish";
+        case ActivationType::SOFTMAX:    return "softmax";
+    }
+    return "linear";
+}
+
+inline bool parse_activation(const std::string& name, ActivationType& type) {
+    for (ActivationType t : { ActivationType::STEP, ActivationType::LINEAR, ActivationType::RELU,
+                              ActivationType::LEAKY_RELU, ActivationType::PRELU,
+                              ActivationType::SIGMOID, ActivationType::TANH, ActivationType::ELU,
+                              ActivationType::SELU, ActivationType::GELU, ActivationType::SWISH,
+                              ActivationType::SOFTMAX }) {
+        if (name == activation_name(t)) {
+            type = t;
+            return true;
+        }
+    }
+    return false;
+}
+
+inline bool save_architecture(Model& model, const std::string& dir) {
+    std::ofstream fout(dir + "/architecture.txt");
+    if (!fout || model.num_layers() == 0) {
+        std::cerr << "ERROR: Cannot write " << dir << "/architecture.txt" << std::endl;
+        return false;
+    }
+    fout << model.layer(0).W.rows;
+    for (int l = 0; l < model.num_layers(); ++l) fout << " " << model.layer(l).W.cols;
+    fout << "\n";
+    for (int l = 0; l < model.num_layers(); ++l)
+        fout << (l ? " " : "") << activation_name(model.layer(l).activation.type);
+    fout << "\n";
+    return static_cast<bool>(fout);
+}
+
+/*
+ * Add the layers described by dir/architecture.txt to `model` (empty;
+ * the layers are owned by it); weights come from load_model_weights
+ */
+inline bool load_architecture(const std::string& dir, Model& model) {
+    const std::string path = dir + "/architecture.txt";
+    std::ifstream fin(path);
+    std::string widths_line, activations_line;
+    if (!fin || !std::getline(fin, widths_line)) {
+        std::cerr << "ERROR: Cannot read " << path << std::endl;
+        return false;
+    }
+    std::getline(fin, activations_line);
+
+    std::vector<int> widths;
+    std::istringstream ws(widths_line);
+    for (std::string token; ws >> token;) {
+        char* end = nullptr;
+        long w = std::strtol(token.c_str(), &end, 10);
+        if (*end || w <= 0) {
+            widths.clear();
+            break;
+        }
+        widths.push_back(static_cast<int>(w));
+    }
+    const int num_layers = static_cast<int>(widths.size()) - 1;
+    bool ok = num_layers >= 1;
+
+    std::vector<ActivationType> acts;
+    std::istringstream as(activations_line);
+    for (std::string name; ok && as >> name;) {
+        ActivationType t;
+        ok = parse_activation(name, t);
+        acts.push_back(t);
+    }
+    if (ok && acts.empty()) {
+        acts.assign(num_layers, ActivationType::RELU);
+        acts.back() = ActivationType::SOFTMAX;
+    }
+    if (!ok || static_cast<int>(acts.size()) != num_layers) {
+        std::cerr << "ERROR: Bad architecture in " << path << std::endl;
+        return false;
+    }
+
+    for (int l = 0; l < num_layers; ++l) model.add(widths[l], widths[l + 1], acts[l]);
+    return true;
+}
@@ -1,6 +1,8 @@
 #pragma once
 #include <vector>
 #include <cmath>
+#include <cstdint>
+#include <algorithm>
 #include <unordered_map>
 
 /*
@@ -11,6 +13,12 @@
 struct Parameter {
     std::vector<float> data;
     std::vector<float> grad;
+
+    // Row-sparse gradient (sparse model inputs): when non-empty, grad
+    // is zero outside these rows of row_size floats, and an optimizer
+    // may skip the other rows where that gives the same update
+    std::vector<int> rows;
+    int row_size = 0;
 };
 
 /*
@@ -19,9 +27,93 @@ struct Parameter {
 class Optimizer {
 public:
     virtual void step(Parameter& param) = 0;
+    // Bytes of per-parameter state (moments, velocity) held so far
+    virtual size_t state_bytes() const { return 0; }
     virtual ~Optimizer() = default;
 };
 
+/*
+ Storage precision of optimizer moments
+ */
+enum class StatePrecision {
+    FP32,
+    INT8
+};
+
+/*
+ Block-wise 8-bit optimizer state
+
+ One code byte per entry plus one fp32 absmax per block of
+ STATE_BLOCK entries (~4x smaller than fp32). Codes are companded so
+ small moments keep relative precision instead of rounding to zero:
+   signed   (Adam m)          : x = absmax * sign(c) * (|c| / 127)^2
+   unsigned (Adam v, RMSProp v): x = absmax * (c / 255)^4
+ m and v round independently against their own block absmax, so a
+ small v can decode to 0 (or far below its true value) while m
+ survives. Exact Adam moments never allow that: by Cauchy-Schwarz,
+   |m_t| <= (1 - b1) / sqrt(1 - b2) * sqrt(sum_{k<t} (b1^2 / b2)^k) * sqrt(v_t)
+ and the int8 step clamps m to this bound, so a lost v cannot turn
+ into an lr * m / eps step.
+
+ Updates dequantize one block into registers/stack, apply the rule,
+ and requantize with the block's new absmax.
+ */
+static const int STATE_BLOCK = 256;
+
+struct QuantizedState {
+    bool is_signed = false;
+    std::vector<uint8_t> codes;
+    std::vector<float> absmax;
+
+    void init(size_t n, bool signed_values) {
+        is_signed = signed_values;
+        codes.assign(n, 0);
+        absmax.assign((n + STATE_BLOCK - 1) / STATE_BLOCK, 0.0f);
+    }
+
+    bool empty() const { return codes.empty(); }
+
+    size_t bytes() const {
+        return codes.size() + absmax.size() * sizeof(float);
+    }
+
+    // x[0..n) <- block `blk`
+    void load(size_t blk, float* x, int n) const {
+        const uint8_t* c = &codes[blk * STATE_BLOCK];
+        const float a = absmax[blk];
+        if (is_signed) {
+            for (int i = 0; i < n; ++i) {
+                float t = static_cast<int8_t>(c[i]) * (1.0f / 127.0f);
+                x[i] = a * t * std::fabs(t);
+            }
+        } else {
+            for (int i = 0; i < n; ++i) {
+                float t = c[i] * (1.0f / 255.0f);
+                t *= t;
+                x[i] = a * t * t;
+            }
+        }
+    }
+
+    // block `blk` <- x[0..n)
+    void store(size_t blk, const float* x, int n) {
+        uint8_t* c = &codes[blk * STATE_BLOCK];
+        float a = 0.0f;
+        for (int i = 0; i < n; ++i) a = std::max(a, std::fabs(x[i]));
+        absmax[blk] = a;
+        const float inv = a > 0.0f ? 1.0f / a : 0.0f;
+        if (is_signed) {
+            for (int i = 0; i < n; ++i) {
+                int q = static_cast<int>(std::sqrt(std::fabs(x[i]) * inv) * 127.0f + 0.5f);
+                c[i] = static_cast<uint8_t>(static_cast<int8_t>(x[i] < 0.0f ? -q : q));
+            }
+        } else {
+            for (int i = 0; i < n; ++i)
+                c[i] = static_cast<uint8_t>(std::sqrt(std::sqrt(x[i] * inv)) * 255.0f + 0.5f);
+        }
+    }
+};
+
 class SGDOptimizer : public Optimizer {
     private:
         float lr;
@@ -47,27 +139,48 @@ class SGDOptimizer : public Optimizer {
                     v[i] = momentum * v[i] - lr * param.grad[i];
                     param.data[i] += v[i];
                 }
+            } else if (!param.rows.empty()) {
+                // Zero-gradient rows would not move
+                for (int r : param.rows) {
+                    const size_t base = static_cast<size_t>(r) * param.row_size;
+                    for (int c = 0; c < param.row_size; ++c)
+                        param.data[base + c] -= lr * param.grad[base + c];
+                }
             } else {
                 for (size_t i = 0; i < param.data.size(); ++i) {
                     param.data[i] -= lr * param.grad[i];
                 }
             }
         }
+
+        size_t state_bytes() const override {
+            size_t total = 0;
+            for (const auto& kv : velocity) total += kv.second.size() * sizeof(float);
+            return total;
+        }
 };
 class RMSPropOptimizer : public Optimizer {
     private:
         float lr;
         float beta;
         float eps;
+        StatePrecision precision;
         std::unordered_map<Parameter*, std::vector<float>> cache;
+        std::unordered_map<Parameter*, QuantizedState> cache_q;
     
     public:
         explicit RMSPropOptimizer(float learning_rate,
                                   float beta = 0.9f,
-                                  float epsilon = 1e-8f)
-            : lr(learning_rate), beta(beta), eps(epsilon) {}
+                                  float epsilon = 1e-8f,
+                                  StatePrecision state = StatePrecision::FP32)
+            : lr(learning_rate), beta(beta), eps(epsilon), precision(state) {}
     
         void step(Parameter& param) override {
+            if (precision == StatePrecision::INT8) {
+                step_int8(param);
+                return;
+            }
+
             auto& v = cache[&param];
             if (v.empty())
                 v.resize(param.data.size(), 0.0f);
@@ -77,6 +190,36 @@ class RMSPropOptimizer : public Optimizer {
                 param.data[i] -= lr * param.grad[i] / (std::sqrt(v[i]) + eps);
             }
         }
+
+        size_t state_bytes() const override {
+            size_t total = 0;
+            for (const auto& kv : cache) total += kv.second.size() * sizeof(float);
+            for (const auto& kv : cache_q) total += kv.second.bytes();
+            return total;
+        }
+
+    private:
+        void step_int8(Parameter& param) {
+            auto& vq = cache_q[&param];
+            if (vq.empty())
+                vq.init(param.data.size(), false);
+
+            float v[STATE_BLOCK];
+            const size_t n = param.data.size();
+            for (size_t blk = 0; blk * STATE_BLOCK < n; ++blk) {
+                const size_t base = blk * STATE_BLOCK;
+                const int len = static_cast<int>(std::min<size_t>(STATE_BLOCK, n - base));
+                const float* g = &param.grad[base];
+                float* w = &param.data[base];
+
+                vq.load(blk, v, len);
+                for (int i = 0; i < len; ++i) {
+                    v[i] = beta * v[i] + (1.0f - beta) * g[i] * g[i];
+                    w[i] -= lr * g[i] / (std::sqrt(v[i]) + eps);
+                }
+                vq.store(blk, v, len);
+            }
+        }
 };
     
 class AdamOptimizer : public Optimizer {
@@ -87,22 +230,33 @@ class AdamOptimizer : public Optimizer {
         float eps;
         int timestep;
     
+        StatePrecision precision;
+    
         std::unordered_map<Parameter*, std::vector<float>> m;
         std::unordered_map<Parameter*, std::vector<float>> v;
+        std::unordered_map<Parameter*, QuantizedState> m_q;
+        std::unordered_map<Parameter*, QuantizedState> v_q;
     
     public:
         explicit AdamOptimizer(float learning_rate,
                                float beta1 = 0.9f,
                                float beta2 = 0.999f,
-                               float epsilon = 1e-8f)
+                               float epsilon = 1e-8f,
+                               StatePrecision state = StatePrecision::FP32)
             : lr(learning_rate),
               beta1(beta1),
               beta2(beta2),
               eps(epsilon),
-              timestep(0) {}
+              timestep(0),
+              precision(state) {}
     
         void step(Parameter& param) override {
             timestep++;
+
+            if (precision == StatePrecision::INT8) {
+                step_int8(param);
+                return;
+            }
     
             auto& m_vec = m[&param];
             auto& v_vec = v[&param];
@@ -122,5 +276,59 @@ class AdamOptimizer : public Optimizer {
                 param.data[i] -= lr * m_hat / (std::sqrt(v_hat) + eps);
             }
         }
+
+        size_t state_bytes() const override {
+            size_t total = 0;
+            for (const auto& kv : m) total += kv.second.size() * sizeof(float);
+            for (const auto& kv : v) total += kv.second.size() * sizeof(float);
+            for (const auto& kv : m_q) total += kv.second.bytes();
+            for (const auto& kv : v_q) total += kv.second.bytes();
+            return total;
+        }
+
+    private:
+        // Fused update: dequantize a block of m and v, step, requantize
+        void step_int8(Parameter& param) {
+            auto& mq = m_q[&param];
+            auto& vq = v_q[&param];
+            if (mq.empty()) {
+                mq.init(param.data.size(), true);
+                vq.init(param.data.size(), false);
+            }
+
+            const float m_corr = 1.0f / (1.0f - std::pow(beta1, timestep));
+            const float v_corr = 1.0f / (1.0f - std::pow(beta2, timestep));
+            const float m_bound = moment_bound();
+
+            float mb[STATE_BLOCK];
+            float vb[STATE_BLOCK];
+            const size_t n = param.data.size();
+            for (size_t blk = 0; blk * STATE_BLOCK < n; ++blk) {
+                const size_t base = blk * STATE_BLOCK;
+                const int len = static_cast<int>(std::min<size_t>(STATE_BLOCK, n - base));
+                const float* g = &param.grad[base];
+                float* w = &param.data[base];
+
+                mq.load(blk, mb, len);
+                vq.load(blk, vb, len);
+                for (int i = 0; i < len; ++i) {
+                    mb[i] = beta1 * mb[i] + (1.0f - beta1) * g[i];
+                    vb[i] = beta2 * vb[i] + (1.0f - beta2) * g[i] * g[i];
+                    const float m_max = m_bound * std::sqrt(vb[i]);
+                    mb[i] = std::max(-m_max, std::min(mb[i], m_max));
+                    w[i] -= lr * (mb[i] * m_corr) / (std::sqrt(vb[i] * v_corr) + eps);
+                }
+                mq.store(blk, mb, len);
+                vq.store(blk, vb, len);
+            }
+        }
+
+        // Largest |m_t| / sqrt(v_t) exact moments can reach at this timestep
+        float moment_bound() const {
+            const double r = static_cast<double>(beta1) * beta1 / beta2;
+            const double sum = r == 1.0 ? timestep
+                                        : (1.0 - std::pow(r, timestep)) / (1.0 - r);
+            return static_cast<float>((1.0 - beta1) / std::sqrt(1.0 - beta2) * std::sqrt(sum));
+        }
 };
     
\ No newline at end of file
@@ -0,0 +1,285 @@
+#pragma once
+
+#include <vector>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <algorithm>
+#include <memory>
+#include <cassert>
+
+#include "tensor.h"
+#include "dense_layer.h"
+#include "model.h"
+
+#if (defined(__AVX512VNNI__) && defined(__AVX512VL__)) || defined(__AVXVNNI__)
+#include <immintrin.h>
+#define DNN_INT8_VNNI 1
+#elif defined(__AVX2__)
+#include <immintrin.h>
+#define DNN_INT8_AVX2 1
+#endif
+
+/*
+ * Post-training int8 quantization
+ *
+ *   weights    : int8, symmetric, one scale per output channel (column of W)
+ *   activations: uint8, affine (scale + zero point), one pair per layer
+ *                input, chosen from ranges seen during calibration
+ *
+ * The GEMM accumulates u8 x s8 products in int32 and requantizes to
+ * fp32 per output channel; bias and activation stay fp32.
+ *
+ * Without VNNI the AVX2 kernel uses pmaddubsw, whose int16 pair sums
+ * can saturate with full 8-bit operands, so activations are limited
+ * to 7 bits there (the usual "reduce range" trade-off).
+ */
+#ifdef DNN_INT8_AVX2
+static const int INT8_ACT_QMAX = 127;
+#else
+static const int INT8_ACT_QMAX = 255;
+#endif
+
+/*
+ * Running min/max of a tensor across calibration batches
+ */
+struct ActivationRange {
+    float min = std::numeric_limits<float>::infinity();
+    float max = -std::numeric_limits<float>::infinity();
+
+    void observe(const float* X, int rows, int cols, int ld) {
+        for (int i = 0; i < rows; ++i) {
+            const float* row = X + static_cast<size_t>(i) * ld;
+            for (int j = 0; j < cols; ++j) {
+                min = std::min(min, row[j]);
+                max = std::max(max, row[j]);
+            }
+        }
+    }
+};
+
+/*
+ * Affine uint8 quantization: q = clamp(round(x / scale) + zero_point, 0, qmax)
+ */
+struct QuantParams {
+    float scale = 1.0f;
+    int zero_point = 0;
+    int qmax = INT8_ACT_QMAX;
+
+    uint8_t quantize(float x) const {
+        int q = static_cast<int>(std::lround(x / scale)) + zero_point;
+        return static_cast<uint8_t>(std::min(std::max(q, 0), qmax));
+    }
+};
+
+inline QuantParams choose_quant_params(const ActivationRange& range, int qmax = INT8_ACT_QMAX) {
+    // Range must contain 0 so that zero (ReLU output, padding) is exact
+    float lo = std::min(range.min, 0.0f);
+    float hi = std::max(range.max, 0.0f);
+
+    QuantParams p;
+    p.qmax = qmax;
+    p.scale = (hi > lo) ? (hi - lo) / qmax : 1.0f;
+    p.zero_point = std::min(std::max(static_cast<int>(std::lround(-lo / p.scale)), 0), qmax);
+    return p;
+}
+
+/*
+ * Calibration pass: runs representative inputs through Model::predict
+ * and records the range of every layer's input
+ */
+class Calibrator {
+public:
+    explicit Calibrator(Model& model)
+        : model(model), ranges(model.num_layers()) {}
+
+    void observe(const Tensor& X) {
+        model.predict(X);
+        collect();
+    }
+
+    // Up to max_batches batches of an epoch (all when negative)
+    void observe(BatchSource& data, int max_batches = -1) {
+        BatchView batch;
+        data.start_epoch(0);
+        for (int n = 0; (max_batches < 0 || n < max_batches) && data.next(batch); ++n) {
+            model.predict(batch);
+            collect();
+        }
+    }
+
+    const std::vector<ActivationRange>& input_ranges() const { return ranges; }
+
+private:
+    Model& model;
+    std::vector<ActivationRange> ranges;
+
+    void collect() {
+        for (int l = 0; l < model.num_layers(); ++l) {
+            const DenseLayer& layer = model.layer(l);
+            ranges[l].observe(layer.input_ptr, layer.input_rows, layer.W.rows, layer.input_ld);
+        }
+    }
+};
+
+/*
+ * Int8 matrix with per-output-channel (column) scales
+ *
+ * Packed for 4-way u8 x s8 dot products (pmaddubsw / vpdpbusd):
+ * columns are grouped 8 at a time, and within a group each input
+ * index quadruple k..k+3 of every column is 4 contiguous bytes:
+ *   packed[((jb * groups + g) * 8 + jj) * 4 + t] = q(4g + t, 8jb + jj)
+ * K and N are zero-padded to multiples of 4 and 8.
+ */
+struct Int8Matrix {
+    int K = 0;
+    int N = 0;
+    int groups = 0;
+    int blocks = 0;
+    std::vector<int8_t> packed;
+    std::vector<float> scales;       // real W(k, j) ~= q(k, j) * scales[j]
+    std::vector<int32_t> col_sums;   // sum_k q(k, j), for zero-point correction
+
+    explicit Int8Matrix(const Tensor& W)
+        : K(W.rows),
+          N(W.cols),
+          groups((W.rows + 3) / 4),
+          blocks((W.cols + 7) / 8),
+          packed(static_cast<size_t>(blocks) * groups * 32, 0),
+          scales(W.cols, 1.0f),
+          col_sums(static_cast<size_t>(blocks) * 8, 0) {
+
+        for (int j = 0; j < N; ++j) {
+            float max_abs = 0.0f;
+            for (int k = 0; k < K; ++k)
+                max_abs = std::max(max_abs, std::fabs(W(k, j)));
+            scales[j] = max_abs > 0.0f ? max_abs / 127.0f : 1.0f;
+
+            for (int k = 0; k < K; ++k) {
+                int q = static_cast<int>(std::lround(W(k, j) / scales[j]));
+                q = std::min(std::max(q, -127), 127);
+                packed[index(k, j)] = static_cast<int8_t>(q);
+                col_sums[j] += q;
+            }
+        }
+    }
+
+    size_t bytes() const {
+        return packed.size() + scales.size() * sizeof(float) + col_sums.size() * sizeof(int32_t);
+    }
+
+    int8_t weight(int k, int j) const { return packed[index(k, j)]; }
+
+    size_t index(int k, int j) const {
+        return ((static_cast<size_t>(j / 8) * groups + k / 4) * 8 + j % 8) * 4 + k % 4;
+    }
+
+    /*
+     * acc[j] = sum_k xq[k] * q(k, j) for all blocks * 8 (padded) columns
+     * xq must hold groups * 4 bytes
+     */
+    void gemv(const uint8_t* xq, int32_t* acc) const {
+        for (int jb = 0; jb < blocks; ++jb) {
+            const int8_t* w = packed.data() + static_cast<size_t>(jb) * groups * 32;
+#if defined(DNN_INT8_VNNI)
+            __m256i sum = _mm256_setzero_si256();
+            for (int g = 0; g < groups; ++g) {
+                int32_t x4;
+                std::memcpy(&x4, xq + 4 * g, 4);
+                __m256i xb = _mm256_set1_epi32(x4);
+                __m256i wv = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(w + g * 32));
+#if defined(__AVX512VNNI__) && defined(__AVX512VL__)
+                sum = _mm256_dpbusd_epi32(sum, xb, wv);
+#else
+                sum = _mm256_dpbusd_avx_epi32(sum, xb, wv);
+#endif
+            }
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(acc + jb * 8), sum);
+#elif defined(DNN_INT8_AVX2)
+            const __m256i ones = _mm256_set1_epi16(1);
+            __m256i sum = _mm256_setzero_si256();
+            for (int g = 0; g < groups; ++g) {
+                int32_t x4;
+                std::memcpy(&x4, xq + 4 * g, 4);
+                __m256i xb = _mm256_set1_epi32(x4);
+                __m256i wv = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(w + g * 32));
+                __m256i pairs = _mm256_maddubs_epi16(xb, wv);
+                sum = _mm256_add_epi32(sum, _mm256_madd_epi16(pairs, ones));
+            }
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(acc + jb * 8), sum);
+#else
+            int32_t sum[8] = { 0, 0, 0, 0, 0, 0, 0, 0 };
+            for (int g = 0; g < groups; ++g) {
+                const uint8_t* x4 = xq + 4 * g;
+                const int8_t* w8 = w + g * 32;
+                for (int jj = 0; jj < 8; ++jj)
+                    for (int t = 0; t < 4; ++t)
+                        sum[jj] += static_cast<int32_t>(x4[t]) * w8[jj * 4 + t];
+            }
+            for (int jj = 0; jj < 8; ++jj) acc[jb * 8 + jj] = sum[jj];
+#endif
+        }
+    }
+};
+
+/*
+ * Int8 GEMM path for a DenseLayer: quantize X with the calibrated
+ * input params, int8 GEMV per row, requantize to fp32 per channel
+ */
+class Int8Weights : public PackedWeights {
+public:
+    Int8Weights(const Tensor& W, const QuantParams& input)
+        : input(input), q(W) {}
+
+    void multiply(const float* X, int rows, int ld, float* out) const override {
+        thread_local std::vector<uint8_t> xq;
+        thread_local std::vector<int32_t> acc;
+        xq.assign(static_cast<size_t>(q.groups) * 4, static_cast<uint8_t>(input.zero_point));
+        acc.resize(static_cast<size_t>(q.blocks) * 8);
+
+        for (int i = 0; i < rows; ++i) {
+            const float* x = X + static_cast<size_t>(i) * ld;
+            for (int k = 0; k < q.K; ++k) xq[k] = input.quantize(x[k]);
+
+            q.gemv(xq.data(), acc.data());
+
+            float* y = out + static_cast<size_t>(i) * q.N;
+            for (int j = 0; j < q.N; ++j) {
+                int32_t a = acc[j] - input.zero_point * q.col_sums[j];
+                y[j] = input.scale * q.scales[j] * static_cast<float>(a);
+            }
+        }
+    }
+
+    size_t bytes() const override { return q.bytes(); }
+
+    int8_t weight(int k, int j) const { return q.weight(k, j); }
+    const std::vector<float>& channel_scales() const { return q.scales; }
+    const QuantParams& input_params() const { return input; }
+
+private:
+    QuantParams input;
+    Int8Matrix q;
+};
+
+/*
+ * Swap every layer of `model` to the int8 path using calibrated
+ * input ranges (one per layer, from Calibrator::input_ranges()).
+ */
+inline void quantize_model(Model& model, const std::vector<ActivationRange>& input_ranges) {
+    assert(static_cast<int>(input_ranges.size()) == model.num_layers());
+    for (int l = 0; l < model.num_layers(); ++l) {
+        DenseLayer& layer = model.layer(l);
+        assert(layer.has_fp32_weights() && "W was freed by release_for_inference");
+        layer.packed.reset(new Int8Weights(layer.W, choose_quant_params(input_ranges[l])));
+    }
+}
+
+// Back to the fp32 path
+inline void dequantize_model(Model& model) {
+    for (int l = 0; l < model.num_layers(); ++l) {
+        assert(model.layer(l).has_fp32_weights() && "W was freed by release_for_inference");
+        model.layer(l).packed.reset();
+    }
+}
@@ -0,0 +1,187 @@
+#pragma once
+
+#include <vector>
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <algorithm>
+
+#include "tensor.h"
+#include "model.h"
+#include "quantization.h"
+
+/*
+ * Integer-only inference engine built from a calibrated Model
+ *
+ *   input  : float -> uint8 once, with the first layer's input params
+ *   layers : u8 x s8 GEMV into int32, integer bias, then requantize
+ *            to the next layer's u8 input with a fixed-point
+ *            multiply + rounding shift; ReLU is the clamp at the
+ *            output zero point
+ *   output : the last layer's int32 accumulators are dequantized to
+ *            float logits (softmax is monotonic, so argmax needs
+ *            nothing more)
+ *
+ * Accumulators are int32: with 8-bit operands and K = 64..256, an
+ * int16 sum would overflow.
+ *
+ * Supported: hidden layers RELU or LINEAR, last layer SOFTMAX or
+ * LINEAR. Not thread-safe (scratch buffers are members).
+ */
+class QuantizedModel {
+public:
+    /*
+     * input_ranges: one per layer input, from Calibrator::input_ranges()
+     */
+    bool build(Model& model, const std::vector<ActivationRange>& input_ranges) {
+        layers.clear();
+        const int L = model.num_layers();
+        if (L == 0 || static_cast<int>(input_ranges.size()) != L) {
+            std::cerr << "ERROR: QuantizedModel needs one calibrated range per layer" << std::endl;
+            return false;
+        }
+
+        for (int l = 0; l < L; ++l) {
+            const DenseLayer& src = model.layer(l);
+            ActivationType act = src.activation.type;
+            bool last = (l == L - 1);
+
+            if (last ? (act != ActivationType::SOFTMAX && act != ActivationType::LINEAR)
+                     : (act != ActivationType::RELU && act != ActivationType::LINEAR)) {
+                std::cerr << "ERROR: Layer " << l + 1
+                          << " activation has no integer-only implementation" << std::endl;
+                return false;
+            }
+
+            layers.emplace_back(src.W);
+            QLayer& q = layers.back();
+            q.input = choose_quant_params(input_ranges[l]);
+            q.relu = (act == ActivationType::RELU);
+
+            // Integer bias, folded with the input zero-point correction
+            q.bias.resize(q.w.N);
+            for (int j = 0; j < q.w.N; ++j) {
+                double acc_scale = static_cast<double>(q.input.scale) * q.w.scales[j];
+                q.bias[j] = static_cast<int32_t>(std::lround(src.b[j] / acc_scale)) -
+                            q.input.zero_point * q.w.col_sums[j];
+            }
+        }
+
+        // Requantization multipliers: acc scale -> next layer's input scale
+        for (int l = 0; l < L; ++l) {
+            QLayer& q = layers[l];
+            q.multiplier.resize(q.w.N);
+            q.shift.resize(q.w.N);
+            q.out_scale.resize(q.w.N);
+            for (int j = 0; j < q.w.N; ++j) {
+                double acc_scale = static_cast<double>(q.input.scale) * q.w.scales[j];
+                q.out_scale[j] = static_cast<float>(acc_scale);
+                if (l + 1 < L)
+                    to_fixed_point(acc_scale / layers[l + 1].input.scale,
+                                   q.multiplier[j], q.shift[j]);
+            }
+            q.xq.assign(static_cast<size_t>(q.w.groups) * 4,
+                        static_cast<uint8_t>(q.input.zero_point));
+            q.acc.resize(static_cast<size_t>(q.w.blocks) * 8);
+        }
+        return true;
+    }
+
+    /*
+     * Logits for each row of X: (rows x output_dim)
+     */
+    Tensor predict(const Tensor& X) {
+        const QLayer& last = layers.back();
+        Tensor logits(X.rows, last.w.N);
+        for (int i = 0; i < X.rows; ++i)
+            run(&X.data[static_cast<size_t>(i) * X.cols], &logits.data[static_cast<size_t>(i) * last.w.N]);
+        return logits;
+    }
+
+    int predict_class(const float* x) {
+        const QLayer& last = layers.back();
+        logits_row.resize(last.w.N);
+        run(x, logits_row.data());
+        return static_cast<int>(std::max_element(logits_row.begin(), logits_row.end()) -
+                                logits_row.begin());
+    }
+
+    size_t bytes() const {
+        size_t total = 0;
+        for (const auto& q : layers)
+            total += q.w.bytes() + q.bias.size() * sizeof(int32_t) +
+                     q.multiplier.size() * (sizeof(int32_t) + sizeof(int));
+        return total;
+    }
+
+private:
+    struct QLayer {
+        explicit QLayer(const Tensor& W) : w(W) {}
+
+        Int8Matrix w;
+        QuantParams input;
+        bool relu = false;
+        std::vector<int32_t> bias;         // bias / acc_scale - zp_in * col_sum
+        std::vector<int32_t> multiplier;   // Q31 fixed-point mantissa
+        std::vector<int> shift;            // total right shift (>= 31)
+        std::vector<float> out_scale;      // acc_scale, last layer only
+        std::vector<uint8_t> xq;           // quantized input (padded)
+        std::vector<int32_t> acc;
+    };
+
+    std::vector<QLayer> layers;
+    std::vector<float> logits_row;
+
+    // real ~= multiplier * 2^-shift, multiplier in [2^30, 2^31)
+    static void to_fixed_point(double real, int32_t& multiplier, int& shift) {
+        if (real <= 0.0) {
+            multiplier = 0;
+            shift = 31;
+            return;
+        }
+        int exp;
+        double mantissa = std::frexp(real, &exp);   // [0.5, 1)
+        int64_t m = static_cast<int64_t>(std::llround(mantissa * (1ll << 31)));
+        if (m == (1ll << 31)) {
+            m /= 2;
+            exp++;
+        }
+        multiplier = static_cast<int32_t>(m);
+        shift = 31 - exp;
+        if (shift > 62) {   // vanishing multiplier
+            multiplier = 0;
+            shift = 31;
+        }
+    }
+
+    static int32_t requantize(int32_t acc, int32_t multiplier, int shift) {
+        int64_t prod = static_cast<int64_t>(acc) * multiplier;
+        return static_cast<int32_t>((prod + (int64_t(1) << (shift - 1))) >> shift);
+    }
+
+    void run(const float* x, float* logits) {
+        QLayer& first = layers.front();
+        for (int k = 0; k < first.w.K; ++k)
+            first.xq[k] = first.input.quantize(x[k]);
+
+        for (size_t l = 0; l < layers.size(); ++l) {
+            QLayer& q = layers[l];
+            q.w.gemv(q.xq.data(), q.acc.data());
+
+            if (l + 1 == layers.size()) {
+                for (int j = 0; j < q.w.N; ++j)
+                    logits[j] = q.out_scale[j] * static_cast<float>(q.acc[j] + q.bias[j]);
+                return;
+            }
+
+            QLayer& next = layers[l + 1];
+            const int zp = next.input.zero_point;
+            const int lo = q.relu ? zp : 0;
+            const int hi = next.input.qmax;
+            for (int j = 0; j < q.w.N; ++j) {
+                int32_t v = zp + requantize(q.acc[j] + q.bias[j], q.multiplier[j], q.shift[j]);
+                next.xq[j] = static_cast<uint8_t>(std::min(std::max(v, lo), hi));
+            }
+        }
+    }
+};
@@ -0,0 +1,175 @@
+#pragma once
+
+#include <vector>
+#include <cmath>
+#include <cstdint>
+#include <algorithm>
+#include <cassert>
+
+#include "tensor.h"
+#include "dense_layer.h"
+#include "model.h"
+
+#if defined(__AVX2__) && defined(__FMA__)
+#include <immintrin.h>
+#define DNN_SPARSE24_AVX2 1
+#endif
+
+/*
+ * 2:4 semi-structured sparsity
+ *
+ * Along the reduction dimension k, every group of 4 weights of a
+ * column keeps at most 2 non-zeros, so each output needs exactly
+ * K / 2 multiplies and W shrinks to half plus 2-bit indices.
+ *
+ * Packed per block of 8 columns and group g of 4 inputs:
+ *   values[((jb * G + g) * 2 + s) * 8 + jj]   slot s of column 8jb + jj
+ *   meta[jb * G + g]                          bits 16s + 2jj .. +1:
+ *                                             index (0..3) of that slot
+ * The kernel loads x[4g .. 4g + 3] once per group and gathers the two
+ * matching inputs of all 8 columns with a register permute
+ * (vpermps), then does two 8-wide FMAs.
+ */
+
+/*
+ * Keep the 2 largest-magnitude weights in each group of 4 inputs of
+ * every column; with keep_mask the layer keeps the pattern through
+ * fit() (see DenseLayer::weight_mask). Updates W and W_param.
+ */
+inline void prune_2_4(DenseLayer& layer, bool keep_mask = true) {
+    Tensor& W = layer.W;
+    std::vector<float> mask(W.data.size(), 1.0f);
+
+    for (int j = 0; j < W.cols; ++j) {
+        for (int k0 = 0; k0 < W.rows; k0 += 4) {
+            const int n = std::min(4, W.rows - k0);
+            if (n <= 2) continue;
+            int order[4] = { 0, 1, 2, 3 };
+            std::sort(order, order + n, [&](int a, int b) {
+                return std::fabs(W(k0 + a, j)) > std::fabs(W(k0 + b, j));
+            });
+            for (int r = 2; r < n; ++r) {
+                W(k0 + order[r], j) = 0.0f;
+                mask[static_cast<size_t>(k0 + order[r]) * W.cols + j] = 0.0f;
+            }
+        }
+    }
+    layer.W_param.data = W.data;
+    if (keep_mask)
+        layer.weight_mask = mask;
+}
+
+// True when every group of 4 inputs of every column has <= 2 non-zeros
+inline bool is_2_4(const Tensor& W) {
+    for (int j = 0; j < W.cols; ++j)
+        for (int k0 = 0; k0 < W.rows; k0 += 4) {
+            int nz = 0;
+            for (int k = k0; k < std::min(k0 + 4, W.rows); ++k)
+                if (W(k, j) != 0.0f) nz++;
+            if (nz > 2) return false;
+        }
+    return true;
+}
+
+class Sparse24Weights : public PackedWeights {
+public:
+    explicit Sparse24Weights(const Tensor& W)
+        : K(W.rows),
+          N(W.cols),
+          G((W.rows + 3) / 4),
+          blocks((W.cols + 7) / 8),
+          values(static_cast<size_t>(blocks) * G * 16, 0.0f),
+          meta(static_cast<size_t>(blocks) * G, 0) {
+        assert(is_2_4(W));
+
+        for (int j = 0; j < N; ++j) {
+            const int jb = j / 8, jj = j % 8;
+            for (int g = 0; g < G; ++g) {
+                int s = 0;
+                uint32_t& m = meta[static_cast<size_t>(jb) * G + g];
+                for (int t = 0; t < 4 && 4 * g + t < K; ++t) {
+                    float w = W(4 * g + t, j);
+                    if (w == 0.0f) continue;
+                    values[((static_cast<size_t>(jb) * G + g) * 2 + s) * 8 + jj] = w;
+                    m |= static_cast<uint32_t>(t) << (16 * s + 2 * jj);
+                    s++;
+                }
+            }
+        }
+    }
+
+    void multiply(const float* X, int rows, int ld, float* out) const override {
+        thread_local std::vector<float> x;
+        thread_local std::vector<float> acc;
+        x.assign(static_cast<size_t>(G) * 4 + 4, 0.0f);   // + 4: 8-float loads of the last group
+        acc.resize(static_cast<size_t>(blocks) * 8);
+
+        for (int i = 0; i < rows; ++i) {
+            std::copy(X + static_cast<size_t>(i) * ld, X + static_cast<size_t>(i) * ld + K, x.begin());
+
+            for (int jb = 0; jb < blocks; ++jb) {
+                const float* v = values.data() + static_cast<size_t>(jb) * G * 16;
+                const uint32_t* m = meta.data() + static_cast<size_t>(jb) * G;
+#ifdef DNN_SPARSE24_AVX2
+                const __m256i shift0 = _mm256_setr_epi32(0, 2, 4, 6, 8, 10, 12, 14);
+                const __m256i shift1 = _mm256_add_epi32(shift0, _mm256_set1_epi32(16));
+                const __m256i three = _mm256_set1_epi32(3);
+                __m256 sum = _mm256_setzero_ps();
+                for (int g = 0; g < G; ++g) {
+                    __m256 x4 = _mm256_loadu_ps(&x[4 * g]);   // lanes 0..3 used
+                    __m256i mv = _mm256_set1_epi32(static_cast<int>(m[g]));
+                    __m256i i0 = _mm256_and_si256(_mm256_srlv_epi32(mv, shift0), three);
+                    __m256i i1 = _mm256_and_si256(_mm256_srlv_epi32(mv, shift1), three);
+                    sum = _mm256_fmadd_ps(_mm256_loadu_ps(v + g * 16),
+                                          _mm256_permutevar8x32_ps(x4, i0), sum);
+                    sum = _mm256_fmadd_ps(_mm256_loadu_ps(v + g * 16 + 8),
+                                          _mm256_permutevar8x32_ps(x4, i1), sum);
+                }
+                _mm256_storeu_ps(&acc[jb * 8], sum);
+#else
+                float sum[8] = { 0, 0, 0, 0, 0, 0, 0, 0 };
+                for (int g = 0; g < G; ++g) {
+                    const float* x4 = &x[4 * g];
+                    for (int jj = 0; jj < 8; ++jj) {
+                        sum[jj] += v[g * 16 + jj] * x4[(m[g] >> (2 * jj)) & 3] +
+                                   v[g * 16 + 8 + jj] * x4[(m[g] >> (16 + 2 * jj)) & 3];
+                    }
+                }
+                std::copy(sum, sum + 8, &acc[jb * 8]);
+#endif
+            }
+            std::copy(acc.begin(), acc.begin() + N, out + static_cast<size_t>(i) * N);
+        }
+    }
+
+    size_t bytes() const override {
+        return values.size() * sizeof(float) + meta.size() * sizeof(uint32_t);
+    }
+
+private:
+    int K;
+    int N;
+    int G;        // groups of 4 inputs
+    int blocks;   // blocks of 8 columns
+    std::vector<float> values;
+    std::vector<uint32_t> meta;
+};
+
+/*
+ * Run every 2:4 layer through Sparse24Weights (others stay dense).
+ * Returns the number of layers switched.
+ */
+inline int set_2_4_weights(Model& model) {
+    int switched = 0;
+    for (int l = 0; l < model.num_layers(); ++l) {
+        DenseLayer& layer = model.layer(l);
+        assert(layer.has_fp32_weights() && "W was freed by release_for_inference");
+        if (is_2_4(layer.W)) {
+            layer.packed.reset(new Sparse24Weights(layer.W));
+            switched++;
+        } else {
+            layer.packed.reset();
+        }
+    }
+    return switched;
+}
@@ -0,0 +1,361 @@
+#pragma once
+
+#include <vector>
+#include <string>
+#include <fstream>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <random>
+#include <numeric>
+#include <algorithm>
+#include <memory>
+#include <cstring>
+#include <cassert>
+
+#include "dataset.h"
+#include "data_loader.h"
+
+/*
+ * Dataset split across many record files
+ *
+ * Manifest: a text file with one shard path per line (relative
+ * paths are resolved against the manifest's directory); blank lines
+ * and lines starting with '#' are ignored.
+ *
+ * Global shuffle, deterministic from (seed, epoch), with no
+ * dataset-wide index:
+ *   1. shard order is permuted,
+ *   2. each shard is cut into blocks of `block_size` records; block
+ *      order and record order inside a block are permuted.
+ *
+ * Shards are dealt round-robin to `num_readers` lanes. Each lane has
+ * its own thread that maps its shards in turn and gathers batches
+ * into a small ring of staging buffers; next() takes batches from the
+ * lanes in a fixed rotation, so all lanes stream from disk at once and
+ * the batch sequence does not depend on thread timing. Lanes and their
+ * (pinned) staging buffers are set up once by open() and reused by
+ * every epoch.
+ *
+ * A shard that cannot be mapped, or no longer matches its header from
+ * open(), ends the epoch: next() returns false and failed() is set
+ * until the next start_epoch.
+ */
+class ShardedDataset : public BatchSource {
+public:
+    ShardedDataset() = default;
+    ShardedDataset(const ShardedDataset&) = delete;
+    ShardedDataset& operator=(const ShardedDataset&) = delete;
+
+    ~ShardedDataset() { stop_lanes(); }
+
+    bool open(const std::string& manifest_path,
+              int batch_size,
+              int num_readers = 4,
+              int block_size = 1024,
+              unsigned seed = 0,
+              int prefetch = 4) {
+        stop_lanes();
+        lanes.clear();
+        shards.clear();
+        total = 0;
+        this->batch_size = batch_size;
+        this->num_readers = std::max(1, num_readers);
+        this->block_size = std::max(1, block_size);
+        this->seed = seed;
+        this->prefetch = std::max(2, prefetch);
+
+        std::ifstream fin(manifest_path);
+        if (!fin) {
+            std::cerr << "ERROR: Cannot open " << manifest_path << std::endl;
+            return false;
+        }
+        std::string dir;
+        size_t slash = manifest_path.find_last_of("/\\");
+        if (slash != std::string::npos) dir = manifest_path.substr(0, slash + 1);
+
+        std::string line;
+        while (std::getline(fin, line)) {
+            size_t b = line.find_first_not_of(" \t\r");
+            if (b == std::string::npos || line[b] == '#') continue;
+            size_t e = line.find_last_not_of(" \t\r");
+            std::string path = line.substr(b, e - b + 1);
+            bool absolute = path[0] == '/' || path[0] == '\\' ||
+                            (path.size() > 1 && path[1] == ':');
+            if (!absolute) path = dir + path;
+
+            // Header only; shards are mapped when a lane reaches them
+            DatasetHeader h;
+            std::ifstream shard(path, std::ios::binary);
+            if (!shard || !shard.read(reinterpret_cast<char*>(&h), sizeof(h))) {
+                std::cerr << "ERROR: Cannot read shard " << path << std::endl;
+                return false;
+            }
+            if (!check_dataset_header(h, path)) return false;
+            if (!shards.empty() && h.num_features != features) {
+                std::cerr << "ERROR: Shard " << path << " has " << h.num_features
+                          << " features, expected " << features << std::endl;
+                return false;
+            }
+            features = h.num_features;
+            shards.push_back({ path, static_cast<int64_t>(h.num_records) });
+            total += static_cast<int64_t>(h.num_records);
+        }
+        if (shards.empty()) {
+            std::cerr << "ERROR: " << manifest_path << " lists no shards" << std::endl;
+            return false;
+        }
+        row_stride = (static_cast<int>(features) + 15) / 16 * 16;   // 64-byte rows
+
+        int lanes_used = std::min<int>(this->num_readers, static_cast<int>(shards.size()));
+        size_t bytes = static_cast<size_t>(batch_size) * row_stride * sizeof(float) +
+                       batch_size * sizeof(int32_t);
+        lanes.clear();
+        for (int l = 0; l < lanes_used; ++l) {
+            auto lane = std::unique_ptr<Lane>(new Lane(this->prefetch));
+            for (auto& slot : lane->slots) slot.buffer.allocate(bytes);
+            lanes.push_back(std::move(lane));
+        }
+        return true;
+    }
+
+    int64_t size() const { return total; }
+    int num_shards() const { return static_cast<int>(shards.size()); }
+    int num_features() const override { return static_cast<int>(features); }
+
+    bool failed() const override {
+        std::lock_guard<std::mutex> lock(mtx);
+        return shard_failed;
+    }
+
+    void start_epoch(int epoch) override {
+        stop_lanes();
+        stopping = false;
+        shard_failed = false;
+
+        std::vector<int> shard_order(shards.size());
+        std::iota(shard_order.begin(), shard_order.end(), 0);
+        std::mt19937_64 rng(epoch_seed(epoch, -1));
+        std::shuffle(shard_order.begin(), shard_order.end(), rng);
+
+        int lanes_used = static_cast<int>(lanes.size());
+        for (int l = 0; l < lanes_used; ++l) {
+            Lane& lane = *lanes[l];
+            lane.shards.clear();
+            for (size_t s = l; s < shard_order.size(); s += lanes_used)
+                lane.shards.push_back(shard_order[s]);
+            for (auto& slot : lane.slots) slot.ready = false;
+            lane.produced = 0;
+            lane.consumed = 0;
+            lane.finished = false;
+        }
+
+        rotation.clear();
+        for (int l = 0; l < lanes_used; ++l) rotation.push_back(l);
+        turn = 0;
+        held_lane = -1;
+
+        for (int l = 0; l < lanes_used; ++l)
+            lanes[l]->thread = std::thread(&ShardedDataset::lane_loop, this, l, epoch);
+    }
+
+    bool next(BatchView& batch) override {
+        std::unique_lock<std::mutex> lock(mtx);
+
+        // Release the slot behind the previous view
+        if (held_lane >= 0) {
+            Lane& prev = *lanes[held_lane];
+            prev.slots[prev.consumed % prev.slots.size()].ready = false;
+            prev.consumed++;
+            held_lane = -1;
+            cv.notify_all();
+        }
+
+        while (!rotation.empty()) {
+            turn %= rotation.size();
+            int l = rotation[turn];
+            Lane& lane = *lanes[l];
+            Slot& slot = lane.slots[lane.consumed % lane.slots.size()];
+
+            cv.wait(lock, [&] {
+                return shard_failed || slot.ready ||
+                       (lane.finished && lane.produced == lane.consumed);
+            });
+            if (shard_failed) return false;
+            if (!slot.ready) {
+                rotation.erase(rotation.begin() + turn);   // lane exhausted
+                continue;
+            }
+
+            batch.features = reinterpret_cast<const float*>(slot.buffer.ptr);
+            batch.labels = reinterpret_cast<const int32_t*>(
+                slot.buffer.ptr + static_cast<size_t>(batch_size) * row_stride * sizeof(float));
+            batch.rows = slot.rows;
+            batch.cols = num_features();
+            batch.stride = row_stride;
+            batch.label_stride = 1;
+
+            held_lane = l;
+            turn++;
+            return true;
+        }
+        return false;
+    }
+
+private:
+    struct ShardInfo {
+        std::string path;
+        int64_t records;
+    };
+
+    struct Slot {
+        StagingBuffer buffer;
+        int rows = 0;
+        bool ready = false;
+    };
+
+    struct Lane {
+        explicit Lane(int prefetch) : slots(prefetch) {}
+        std::vector<int> shards;
+        std::vector<Slot> slots;
+        int64_t produced = 0;
+        int64_t consumed = 0;
+        bool finished = false;
+        std::thread thread;
+    };
+
+    std::vector<ShardInfo> shards;
+    uint32_t features = 0;
+    int64_t total = 0;
+    int batch_size = 0;
+    int num_readers = 1;
+    int block_size = 1;
+    unsigned seed = 0;
+    int prefetch = 2;
+    int row_stride = 0;
+
+    std::vector<std::unique_ptr<Lane>> lanes;
+    std::vector<int> rotation;   // lanes that may still produce batches
+    size_t turn = 0;
+    int held_lane = -1;          // lane whose slot backs the last view
+
+    mutable std::mutex mtx;
+    std::condition_variable cv;
+    bool stopping = false;
+    bool shard_failed = false;   // this epoch hit a bad shard
+
+    uint64_t epoch_seed(int epoch, int shard) const {
+        uint64_t h = static_cast<uint64_t>(seed) * 0x9E3779B97F4A7C15ull;
+        h ^= (static_cast<uint64_t>(epoch) + 1) * 0xC2B2AE3D27D4EB4Full;
+        h ^= (static_cast<uint64_t>(shard) + 2) * 0x165667B19E3779F9ull;
+        return h;
+    }
+
+    // Producer side: wait for a free slot, or return null when stopping
+    Slot* acquire(Lane& lane) {
+        std::unique_lock<std::mutex> lock(mtx);
+        Slot& slot = lane.slots[lane.produced % lane.slots.size()];
+        cv.wait(lock, [&] {
+            return stopping ||
+                   (!slot.ready &&
+                    lane.produced - lane.consumed < static_cast<int64_t>(lane.slots.size()));
+        });
+        return stopping ? nullptr : &slot;
+    }
+
+    void publish(Lane& lane, Slot& slot, int rows) {
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            slot.rows = rows;
+            slot.ready = true;
+            lane.produced++;
+        }
+        cv.notify_all();
+    }
+
+    void lane_loop(int l, int epoch) {
+        Lane& lane = *lanes[l];
+        const size_t feature_bytes = features * sizeof(float);
+        const size_t labels_at = static_cast<size_t>(batch_size) * row_stride * sizeof(float);
+
+        Slot* slot = nullptr;
+        int rows = 0;   // rows gathered into `slot` so far (batches span shards)
+
+        for (int shard_id : lane.shards) {
+            Dataset data;
+            if (!data.open(shards[shard_id].path)) {
+                fail();
+                return;
+            }
+            if (data.size() != shards[shard_id].records ||
+                data.num_features() != static_cast<int>(features)) {
+                std::cerr << "ERROR: Shard " << shards[shard_id].path
+                          << " changed since open()" << std::endl;
+                fail();
+                return;
+            }
+
+            std::mt19937_64 rng(epoch_seed(epoch, shard_id));
+            int64_t num_blocks = (data.size() + block_size - 1) / block_size;
+            std::vector<int64_t> blocks(num_blocks);
+            std::iota(blocks.begin(), blocks.end(), 0);
+            std::shuffle(blocks.begin(), blocks.end(), rng);
+
+            std::vector<int> in_block;
+            for (int64_t blk : blocks) {
+                int64_t first = blk * block_size;
+                int n = static_cast<int>(std::min<int64_t>(block_size, data.size() - first));
+                data.prefetch(first, n);
+                in_block.resize(n);
+                std::iota(in_block.begin(), in_block.end(), 0);
+                std::shuffle(in_block.begin(), in_block.end(), rng);
+
+                for (int k : in_block) {
+                    if (!slot) {
+                        slot = acquire(lane);
+                        if (!slot) return;
+                        rows = 0;
+                    }
+                    int64_t i = first + k;
+                    std::memcpy(reinterpret_cast<float*>(slot->buffer.ptr) +
+                                    static_cast<size_t>(rows) * row_stride,
+                                data.record(i), feature_bytes);
+                    reinterpret_cast<int32_t*>(slot->buffer.ptr + labels_at)[rows] =
+                        data.label(i);
+
+                    if (++rows == batch_size) {
+                        publish(lane, *slot, rows);
+                        slot = nullptr;
+                    }
+                }
+            }
+        }
+        if (slot && rows > 0) publish(lane, *slot, rows);
+
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            lane.finished = true;
+        }
+        cv.notify_all();
+    }
+
+    // A lane gave up: end the epoch for every lane and the consumer
+    void fail() {
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            shard_failed = true;
+            stopping = true;
+        }
+        cv.notify_all();
+    }
+
+    void stop_lanes() {
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            stopping = true;
+        }
+        cv.notify_all();
+        for (auto& lane : lanes)
+            if (lane->thread.joinable()) lane->thread.join();
+    }
+};
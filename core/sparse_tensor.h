@@ -0,0 +1,269 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <algorithm>
+#include <cassert>
+
+#include "tensor.h"
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define DNN_SPARSE_TENSOR_AVX2 1
+#endif
+
+/*
+ * Sparse 2D tensor in CSR (compressed sparse row) form
+ *   row_ptr[i] .. row_ptr[i + 1]   entries of row i
+ *   col_idx[p], values[p]          column and value of entry p
+ * Used for mostly-zero model inputs: the first layer only touches the
+ * rows of W that match non-zero features.
+ */
+struct SparseTensor {
+    int rows;
+    int cols;
+    std::vector<int> row_ptr;     // (rows + 1)
+    std::vector<int> col_idx;     // (nnz), ascending within a row
+    std::vector<float> values;    // (nnz)
+
+    SparseTensor() : rows(0), cols(0), row_ptr(1, 0) {}
+
+    SparseTensor(int r, int c) : rows(r), cols(c), row_ptr(r + 1, 0) {}
+
+    /*
+     * Non-zeros of X (rows x cols), row stride ld
+     */
+    static SparseTensor from_dense(const float* X, int r, int c, int ld) {
+        SparseTensor s(r, c);
+        for (int i = 0; i < r; ++i) {
+            const float* x = X + static_cast<size_t>(i) * ld;
+            for (int k = 0; k < c; ++k) {
+                if (x[k] == 0.0f) continue;
+                s.col_idx.push_back(k);
+                s.values.push_back(x[k]);
+            }
+            s.row_ptr[i + 1] = static_cast<int>(s.col_idx.size());
+        }
+        return s;
+    }
+
+    static SparseTensor from_dense(const Tensor& X) {
+        return from_dense(X.data.data(), X.rows, X.cols, X.cols);
+    }
+
+    Tensor to_dense() const {
+        Tensor X(rows, cols);
+        for (int i = 0; i < rows; ++i)
+            for (int p = row_ptr[i]; p < row_ptr[i + 1]; ++p)
+                X(i, col_idx[p]) = values[p];
+        return X;
+    }
+
+    // Rows [start, start + count) as a new tensor
+    SparseTensor slice_rows(int start, int count) const {
+        assert(start >= 0 && count >= 0 && start + count <= rows);
+        SparseTensor s(count, cols);
+        const int first = row_ptr[start], last = row_ptr[start + count];
+        s.col_idx.assign(col_idx.begin() + first, col_idx.begin() + last);
+        s.values.assign(values.begin() + first, values.begin() + last);
+        for (int i = 0; i <= count; ++i) s.row_ptr[i] = row_ptr[start + i] - first;
+        return s;
+    }
+
+    int nnz() const { return static_cast<int>(values.size()); }
+
+    float density() const {
+        return rows * cols > 0 ? static_cast<float>(nnz()) / (static_cast<float>(rows) * cols) : 0.0f;
+    }
+};
+
+/*
+ * Sparse x dense: C = A * B
+ * A: (m x k) sparse
+ * B: (k x n), contiguous
+ * C: (m x n), contiguous, overwritten
+ *
+ * Each non-zero A(i, p) adds A(i, p) * B(p, :) to C(i, :); rows of B
+ * for zero features are never read.
+ */
+inline void spmm(const SparseTensor& A, const float* B, int n, float* C) {
+    for (int i = 0; i < A.rows; ++i) {
+        float* c_row = C + static_cast<size_t>(i) * n;
+        for (int j = 0; j < n; ++j) c_row[j] = 0.0f;
+
+        for (int p = A.row_ptr[i]; p < A.row_ptr[i + 1]; ++p) {
+            const float a = A.values[p];
+            const float* b_row = B + static_cast<size_t>(A.col_idx[p]) * n;
+            for (int j = 0; j < n; ++j) {
+                c_row[j] += a * b_row[j];
+            }
+        }
+    }
+}
+
+/*
+ * Transposed sparse x dense, accumulated: C += A^T * B
+ * A: (m x k) sparse
+ * B: (m x n), contiguous
+ * C: (k x n), contiguous
+ *
+ * Only rows of C that match a column present in A are written
+ * (row-sparse dW = X^T * dOut).
+ */
+inline void spmm_tn_accumulate(const SparseTensor& A, const float* B, int n, float* C) {
+    for (int i = 0; i < A.rows; ++i) {
+        const float* b_row = B + static_cast<size_t>(i) * n;
+        for (int p = A.row_ptr[i]; p < A.row_ptr[i + 1]; ++p) {
+            const float a = A.values[p];
+            float* c_row = C + static_cast<size_t>(A.col_idx[p]) * n;
+            for (int j = 0; j < n; ++j) {
+                c_row[j] += a * b_row[j];
+            }
+        }
+    }
+}
+
+// Distinct columns with a non-zero in A, ascending
+inline std::vector<int> nonzero_columns(const SparseTensor& A) {
+    std::vector<char> seen(A.cols, 0);
+    for (int c : A.col_idx) seen[c] = 1;
+    std::vector<int> cols;
+    for (int c = 0; c < A.cols; ++c)
+        if (seen[c]) cols.push_back(c);
+    return cols;
+}
+
+/*
+ * One bit per element of a dense (rows x cols) matrix, each row
+ * padded to whole 64-bit words. RELU / LEAKY_RELU record x > 0 of
+ * their input in one: it is all their backward needs, and for RELU it
+ * is also the non-zero pattern of the output, which the next layer
+ * uses to skip zero inputs (Activation::output_nonzeros).
+ */
+struct BitMask {
+    int rows = 0;
+    int cols = 0;
+    int words = 0;                 // per row
+    int count = 0;                 // set bits
+    std::vector<uint64_t> bits;    // (rows x words)
+
+    // bit (i, k) = X(i, k) > 0; X: (r x c), row stride ld
+    void build_positive(const float* X, int r, int c, int ld) {
+        rows = r;
+        cols = c;
+        words = (c + 63) / 64;
+        bits.assign(static_cast<size_t>(r) * words, 0ULL);
+        count = 0;
+        for (int i = 0; i < r; ++i) {
+            const float* x = X + static_cast<size_t>(i) * ld;
+            uint64_t* row_bits = &bits[static_cast<size_t>(i) * words];
+            int k = 0;
+#ifdef DNN_SPARSE_TENSOR_AVX2
+            const __m256 zero = _mm256_setzero_ps();
+            for (; k + 8 <= c; k += 8) {
+                uint64_t m = static_cast<uint32_t>(
+                    _mm256_movemask_ps(_mm256_cmp_ps(_mm256_loadu_ps(x + k), zero, _CMP_GT_OQ)));
+                row_bits[k / 64] |= m << (k % 64);
+            }
+#endif
+            for (; k < c; ++k)
+                if (x[k] > 0.0f) row_bits[k / 64] |= 1ULL << (k % 64);
+            for (int w = 0; w < words; ++w) count += __builtin_popcountll(row_bits[w]);
+        }
+    }
+
+    const uint64_t* row(int i) const { return &bits[static_cast<size_t>(i) * words]; }
+
+    bool test(int i, int k) const { return row(i)[k / 64] >> (k % 64) & 1; }
+
+    int nnz() const { return count; }
+
+    float density() const {
+        return rows * cols > 0 ? static_cast<float>(count) / (static_cast<float>(rows) * cols) : 0.0f;
+    }
+
+    size_t bytes() const { return bits.size() * sizeof(uint64_t); }
+};
+
+// Calls fn(k) for every set bit k of a mask row, ascending
+template <typename Fn>
+inline void for_each_set_bit(const uint64_t* row_bits, int words, Fn fn) {
+    for (int w = 0; w < words; ++w) {
+        uint64_t word = row_bits[w];
+        while (word) {
+            fn(w * 64 + __builtin_ctzll(word));
+            word &= word - 1;
+        }
+    }
+}
+
+/*
+ * C = A * B reading only the entries of A set in `mask`
+ * A: (m x k), row stride lda
+ * B: (k x n), contiguous
+ * C: (m x n), contiguous, overwritten
+ */
+inline void gemm_masked(const float* A, int lda, const BitMask& mask,
+                        const float* B, int n, float* C) {
+    for (int i = 0; i < mask.rows; ++i) {
+        float* c_row = C + static_cast<size_t>(i) * n;
+        for (int j = 0; j < n; ++j) c_row[j] = 0.0f;
+
+        const float* a_row = A + static_cast<size_t>(i) * lda;
+        for_each_set_bit(mask.row(i), mask.words, [&](int k) {
+            const float a = a_row[k];
+            const float* b_row = B + static_cast<size_t>(k) * n;
+            for (int j = 0; j < n; ++j) {
+                c_row[j] += a * b_row[j];
+            }
+        });
+    }
+}
+
+/*
+ * C = A^T * B reading only the entries of A set in `mask`
+ * A: (m x k), row stride lda
+ * B: (m x n), contiguous
+ * C: (k x n), contiguous, overwritten
+ */
+inline void gemm_tn_masked(const float* A, int lda, const BitMask& mask,
+                           const float* B, int n, float* C) {
+    for (size_t i = 0; i < static_cast<size_t>(mask.cols) * n; ++i) C[i] = 0.0f;
+
+    for (int i = 0; i < mask.rows; ++i) {
+        const float* a_row = A + static_cast<size_t>(i) * lda;
+        const float* b_row = B + static_cast<size_t>(i) * n;
+        for_each_set_bit(mask.row(i), mask.words, [&](int k) {
+            const float a = a_row[k];
+            float* c_row = C + static_cast<size_t>(k) * n;
+            for (int j = 0; j < n; ++j) {
+                c_row[j] += a * b_row[j];
+            }
+        });
+    }
+}
+
+/*
+ * C = A * B^T for the entries of C set in `mask` (others set to 0)
+ * A: (m x n), contiguous
+ * B: (k x n), contiguous
+ * C: (m x k), contiguous, overwritten
+ *
+ * dX of a layer whose input came from a RELU: where the input was
+ * zero the RELU derivative is zero too, so those entries are unused.
+ */
+inline void gemm_nt_masked(const float* A, int n, const float* B,
+                           const BitMask& mask, float* C) {
+    for (size_t i = 0; i < static_cast<size_t>(mask.rows) * mask.cols; ++i) C[i] = 0.0f;
+
+    for (int i = 0; i < mask.rows; ++i) {
+        const float* a_row = A + static_cast<size_t>(i) * n;
+        float* c_row = C + static_cast<size_t>(i) * mask.cols;
+        for_each_set_bit(mask.row(i), mask.words, [&](int k) {
+            const float* b_row = B + static_cast<size_t>(k) * n;
+            float sum = 0.0f;
+            for (int j = 0; j < n; ++j) sum += a_row[j] * b_row[j];
+            c_row[k] = sum;
+        });
+    }
+}
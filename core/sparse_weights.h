@@ -0,0 +1,191 @@
+#pragma once
+
+#include <vector>
+#include <cmath>
+#include <cstdint>
+#include <algorithm>
+#include <cassert>
+
+#include "tensor.h"
+#include "dense_layer.h"
+#include "model.h"
+
+#if defined(__AVX2__) && defined(__FMA__)
+#include <immintrin.h>
+#define DNN_SPARSE_AVX2 1
+#endif
+
+/*
+ * Magnitude pruning + block-sparse execution
+ *
+ * W (K x N) is cut into 1 x SPARSE_BLOCK tiles along each row, i.e.
+ * 8 consecutive output columns fed by one input. Pruning ranks tiles
+ * by L2 norm (or single weights, with block = 1) and zeroes the
+ * smallest until the target sparsity is reached.
+ *
+ * BlockSparseWeights keeps only the non-zero tiles, block-CSR by
+ * input row:
+ *   row_ptr[k] .. row_ptr[k + 1]  tiles of row k
+ *   block_col[t]                  first output column / 8
+ *   values[t * 8 .. t * 8 + 8)    the tile
+ * so out(i, :) += X(i, k) * tile is one 8-wide FMA, and a zero input
+ * (ReLU) skips its whole row of W.
+ */
+static const int SPARSE_BLOCK = 8;
+
+/*
+ * Zero the smallest-magnitude weights of `layer` to `sparsity`
+ * (fraction of zeros). block = 1 prunes single weights, block = 8
+ * prunes whole 1 x 8 tiles (what the sparse kernel can skip). With
+ * keep_mask the layer keeps the pattern through fit() (see
+ * DenseLayer::weight_mask). Updates W and W_param.
+ */
+inline void magnitude_prune(DenseLayer& layer, float sparsity, int block = SPARSE_BLOCK,
+                            bool keep_mask = true) {
+    assert(block == 1 || block == SPARSE_BLOCK);
+    Tensor& W = layer.W;
+    const int tiles_per_row = (W.cols + block - 1) / block;
+    const size_t num_tiles = static_cast<size_t>(W.rows) * tiles_per_row;
+
+    std::vector<float> norms(num_tiles, 0.0f);
+    for (int k = 0; k < W.rows; ++k)
+        for (int j = 0; j < W.cols; ++j)
+            norms[static_cast<size_t>(k) * tiles_per_row + j / block] += W(k, j) * W(k, j);
+
+    size_t prune = static_cast<size_t>(std::lround(sparsity * num_tiles));
+    prune = std::min(prune, num_tiles);
+    if (prune == 0) return;
+
+    std::vector<size_t> order(num_tiles);
+    for (size_t t = 0; t < num_tiles; ++t) order[t] = t;
+    std::nth_element(order.begin(), order.begin() + (prune - 1), order.end(),
+                     [&](size_t a, size_t b) { return norms[a] < norms[b]; });
+
+    std::vector<float> mask(W.data.size(), 1.0f);
+    for (size_t r = 0; r < prune; ++r) {
+        size_t t = order[r];
+        int k = static_cast<int>(t / tiles_per_row);
+        int j0 = static_cast<int>(t % tiles_per_row) * block;
+        for (int j = j0; j < std::min(j0 + block, W.cols); ++j) {
+            W(k, j) = 0.0f;
+            mask[static_cast<size_t>(k) * W.cols + j] = 0.0f;
+        }
+    }
+    layer.W_param.data = W.data;
+    if (keep_mask)
+        layer.weight_mask = mask;
+}
+
+// Fraction of exactly-zero entries
+inline float weight_sparsity(const Tensor& W) {
+    size_t zeros = 0;
+    for (float w : W.data)
+        if (w == 0.0f) zeros++;
+    return W.data.empty() ? 0.0f : static_cast<float>(zeros) / W.data.size();
+}
+
+// Fraction of 1 x SPARSE_BLOCK tiles that are all zero
+inline float block_sparsity(const Tensor& W) {
+    const int tiles_per_row = (W.cols + SPARSE_BLOCK - 1) / SPARSE_BLOCK;
+    size_t empty = 0;
+    for (int k = 0; k < W.rows; ++k) {
+        for (int jb = 0; jb < tiles_per_row; ++jb) {
+            bool zero = true;
+            for (int j = jb * SPARSE_BLOCK; j < std::min((jb + 1) * SPARSE_BLOCK, W.cols); ++j)
+                zero &= (W(k, j) == 0.0f);
+            if (zero) empty++;
+        }
+    }
+    return static_cast<float>(empty) / (static_cast<size_t>(W.rows) * tiles_per_row);
+}
+
+class BlockSparseWeights : public PackedWeights {
+public:
+    explicit BlockSparseWeights(const Tensor& W)
+        : K(W.rows),
+          N(W.cols),
+          Np((W.cols + SPARSE_BLOCK - 1) / SPARSE_BLOCK * SPARSE_BLOCK),
+          row_ptr(W.rows + 1, 0) {
+        const int tiles_per_row = Np / SPARSE_BLOCK;
+        for (int k = 0; k < K; ++k) {
+            for (int jb = 0; jb < tiles_per_row; ++jb) {
+                float tile[SPARSE_BLOCK] = { 0, 0, 0, 0, 0, 0, 0, 0 };
+                bool zero = true;
+                for (int t = 0; t < SPARSE_BLOCK && jb * SPARSE_BLOCK + t < N; ++t) {
+                    tile[t] = W(k, jb * SPARSE_BLOCK + t);
+                    zero &= (tile[t] == 0.0f);
+                }
+                if (zero) continue;
+                block_col.push_back(jb);
+                values.insert(values.end(), tile, tile + SPARSE_BLOCK);
+            }
+            row_ptr[k + 1] = static_cast<int>(block_col.size());
+        }
+    }
+
+    void multiply(const float* X, int rows, int ld, float* out) const override {
+        thread_local std::vector<float> acc;
+        acc.resize(Np);
+
+        for (int i = 0; i < rows; ++i) {
+            const float* x = X + static_cast<size_t>(i) * ld;
+            std::fill(acc.begin(), acc.end(), 0.0f);
+
+            for (int k = 0; k < K; ++k) {
+                const float xk = x[k];
+                if (xk == 0.0f) continue;
+#ifdef DNN_SPARSE_AVX2
+                const __m256 xv = _mm256_set1_ps(xk);
+                for (int t = row_ptr[k]; t < row_ptr[k + 1]; ++t) {
+                    float* a = acc.data() + block_col[t] * SPARSE_BLOCK;
+                    __m256 w = _mm256_loadu_ps(&values[static_cast<size_t>(t) * SPARSE_BLOCK]);
+                    _mm256_storeu_ps(a, _mm256_fmadd_ps(xv, w, _mm256_loadu_ps(a)));
+                }
+#else
+                for (int t = row_ptr[k]; t < row_ptr[k + 1]; ++t) {
+                    float* a = acc.data() + block_col[t] * SPARSE_BLOCK;
+                    const float* w = &values[static_cast<size_t>(t) * SPARSE_BLOCK];
+                    for (int u = 0; u < SPARSE_BLOCK; ++u) a[u] += xk * w[u];
+                }
+#endif
+            }
+            std::copy(acc.begin(), acc.begin() + N, out + static_cast<size_t>(i) * N);
+        }
+    }
+
+    size_t bytes() const override {
+        return values.size() * sizeof(float) +
+               block_col.size() * sizeof(uint16_t) + row_ptr.size() * sizeof(int);
+    }
+
+    int num_blocks() const { return static_cast<int>(block_col.size()); }
+
+private:
+    int K;
+    int N;
+    int Np;
+    std::vector<int> row_ptr;          // (K + 1)
+    std::vector<uint16_t> block_col;   // per tile
+    std::vector<float> values;         // per tile, SPARSE_BLOCK each
+};
+
+/*
+ * Run every layer whose tile sparsity is at least `min_block_sparsity`
+ * through BlockSparseWeights; the rest stay on the dense path. Below
+ * ~50% empty tiles the index overhead outweighs the skipped work.
+ * Returns the number of layers switched.
+ */
+inline int set_sparse_weights(Model& model, float min_block_sparsity = 0.5f) {
+    int switched = 0;
+    for (int l = 0; l < model.num_layers(); ++l) {
+        DenseLayer& layer = model.layer(l);
+        assert(layer.has_fp32_weights() && "W was freed by release_for_inference");
+        if (block_sparsity(layer.W) >= min_block_sparsity) {
+            layer.packed.reset(new BlockSparseWeights(layer.W));
+            switched++;
+        } else {
+            layer.packed.reset();
+        }
+    }
+    return switched;
+}
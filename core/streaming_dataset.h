@@ -0,0 +1,521 @@
+#pragma once
+
+#include <vector>
+#include <string>
+#include <random>
+#include <numeric>
+#include <algorithm>
+#include <cstring>
+#include <cerrno>
+#include <cassert>
+
+#include "dataset.h"
+#include "data_loader.h"
+
+#if defined(__linux__)
+#include <sys/syscall.h>
+#include <linux/io_uring.h>
+#if defined(__NR_io_uring_setup) && defined(__NR_io_uring_enter)
+#define DNN_HAVE_IO_URING 1
+#endif
+#endif
+
+#ifdef DNN_HAVE_IO_URING
+/*
+ * Minimal io_uring wrapper (raw syscalls, no liburing)
+ * Only what the streaming reader needs: queue reads, wait for one
+ * completion.
+ */
+class IoUring {
+public:
+    IoUring() = default;
+    IoUring(const IoUring&) = delete;
+    IoUring& operator=(const IoUring&) = delete;
+
+    ~IoUring() { close(); }
+
+    bool init(unsigned entries) {
+        io_uring_params p;
+        std::memset(&p, 0, sizeof(p));
+        ring_fd = static_cast<int>(syscall(__NR_io_uring_setup, entries, &p));
+        if (ring_fd < 0) return false;
+
+        sq_bytes = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+        cq_bytes = p.cq_off.cqes + p.cq_entries * sizeof(io_uring_cqe);
+        bool single_mmap = false;
+#ifdef IORING_FEAT_SINGLE_MMAP
+        single_mmap = (p.features & IORING_FEAT_SINGLE_MMAP) != 0;
+#endif
+        if (single_mmap) sq_bytes = cq_bytes = std::max(sq_bytes, cq_bytes);
+
+        sq_ptr = mmap(nullptr, sq_bytes, PROT_READ | PROT_WRITE,
+                      MAP_SHARED | MAP_POPULATE, ring_fd, IORING_OFF_SQ_RING);
+        if (sq_ptr == MAP_FAILED) { sq_ptr = nullptr; close(); return false; }
+
+        if (single_mmap) {
+            cq_ptr = sq_ptr;
+        } else {
+            cq_ptr = mmap(nullptr, cq_bytes, PROT_READ | PROT_WRITE,
+                          MAP_SHARED | MAP_POPULATE, ring_fd, IORING_OFF_CQ_RING);
+            if (cq_ptr == MAP_FAILED) { cq_ptr = nullptr; close(); return false; }
+        }
+
+        sqe_bytes = p.sq_entries * sizeof(io_uring_sqe);
+        void* s = mmap(nullptr, sqe_bytes, PROT_READ | PROT_WRITE,
+                       MAP_SHARED | MAP_POPULATE, ring_fd, IORING_OFF_SQES);
+        if (s == MAP_FAILED) { close(); return false; }
+        sqes = static_cast<io_uring_sqe*>(s);
+
+        char* sq = static_cast<char*>(sq_ptr);
+        sq_head = reinterpret_cast<unsigned*>(sq + p.sq_off.head);
+        sq_tail = reinterpret_cast<unsigned*>(sq + p.sq_off.tail);
+        sq_mask = *reinterpret_cast<unsigned*>(sq + p.sq_off.ring_mask);
+        sq_array = reinterpret_cast<unsigned*>(sq + p.sq_off.array);
+
+        char* cq = static_cast<char*>(cq_ptr);
+        cq_head = reinterpret_cast<unsigned*>(cq + p.cq_off.head);
+        cq_tail = reinterpret_cast<unsigned*>(cq + p.cq_off.tail);
+        cq_mask = *reinterpret_cast<unsigned*>(cq + p.cq_off.ring_mask);
+        cqes = reinterpret_cast<io_uring_cqe*>(cq + p.cq_off.cqes);
+        return true;
+    }
+
+    void close() {
+        if (sqes) munmap(sqes, sqe_bytes);
+        if (cq_ptr && cq_ptr != sq_ptr) munmap(cq_ptr, cq_bytes);
+        if (sq_ptr) munmap(sq_ptr, sq_bytes);
+        if (ring_fd >= 0) ::close(ring_fd);
+        sqes = nullptr;
+        sq_ptr = cq_ptr = nullptr;
+        ring_fd = -1;
+    }
+
+    /*
+     * Queue and submit one read; user_data comes back with the completion
+     * Returns false when the kernel did not take the read: the entry
+     * is withdrawn from the queue, so it can never be submitted later
+     * behind the caller's back.
+     */
+    bool read(int fd, void* buf, unsigned len, uint64_t offset, uint64_t user_data) {
+        unsigned tail = *sq_tail;
+        unsigned idx = tail & sq_mask;
+        io_uring_sqe* sqe = &sqes[idx];
+        std::memset(sqe, 0, sizeof(*sqe));
+        sqe->opcode = IORING_OP_READ;
+        sqe->fd = fd;
+        sqe->addr = reinterpret_cast<uint64_t>(buf);
+        sqe->len = len;
+        sqe->off = offset;
+        sqe->user_data = user_data;
+        sq_array[idx] = idx;
+        __atomic_store_n(sq_tail, tail + 1, __ATOMIC_RELEASE);
+
+        long r;
+        do {
+            r = syscall(__NR_io_uring_enter, ring_fd, 1, 0, 0, nullptr, 0);
+        } while (r < 0 && errno == EINTR);
+        if (r == 1) return true;
+
+        // The kernel consumes entries only inside io_uring_enter: if the
+        // head moved past it, the read is in flight after all
+        if (__atomic_load_n(sq_head, __ATOMIC_ACQUIRE) == tail + 1) return true;
+        __atomic_store_n(sq_tail, tail, __ATOMIC_RELEASE);
+        return false;
+    }
+
+    // Block until one completion is available
+    bool wait(uint64_t& user_data, int& result) {
+        while (true) {
+            unsigned head = *cq_head;
+            if (head != __atomic_load_n(cq_tail, __ATOMIC_ACQUIRE)) {
+                const io_uring_cqe& cqe = cqes[head & cq_mask];
+                user_data = cqe.user_data;
+                result = cqe.res;
+                __atomic_store_n(cq_head, head + 1, __ATOMIC_RELEASE);
+                return true;
+            }
+            long r = syscall(__NR_io_uring_enter, ring_fd, 0, 1,
+                             IORING_ENTER_GETEVENTS, nullptr, 0);
+            if (r < 0 && errno != EINTR) return false;
+        }
+    }
+
+private:
+    int ring_fd = -1;
+    void* sq_ptr = nullptr;
+    void* cq_ptr = nullptr;
+    size_t sq_bytes = 0;
+    size_t cq_bytes = 0;
+    size_t sqe_bytes = 0;
+
+    io_uring_sqe* sqes = nullptr;
+    unsigned* sq_head = nullptr;
+    unsigned* sq_tail = nullptr;
+    unsigned* sq_array = nullptr;
+    unsigned sq_mask = 0;
+
+    unsigned* cq_head = nullptr;
+    unsigned* cq_tail = nullptr;
+    io_uring_cqe* cqes = nullptr;
+    unsigned cq_mask = 0;
+};
+#endif
+
+/*
+ * Out-of-core streaming dataset (record format, see dataset.h)
+ *
+ * Instead of mapping the file, the record region is read in large
+ * chunks (whole batches each) into a ring of `depth` aligned buffers.
+ * With io_uring, `depth` reads are kept in flight with O_DIRECT, so
+ * the training thread never takes a page fault on dataset memory.
+ * Kernels without io_uring (or non-Linux builds) fall back to pread,
+ * one chunk at a time.
+ *
+ * Batches are views into the chunk buffers; chunk order can be
+ * shuffled per epoch from `seed`, records within a chunk stay in
+ * file order.
+ *
+ * A read that fails or comes back short (also after the pread
+ * retry) ends the epoch: next() returns false and failed() is set
+ * until the next start_epoch().
+ */
+class StreamingDataset : public BatchSource {
+public:
+    static constexpr size_t IO_ALIGNMENT = 4096;   // O_DIRECT offset/length/buffer
+
+    StreamingDataset() = default;
+    StreamingDataset(const StreamingDataset&) = delete;
+    StreamingDataset& operator=(const StreamingDataset&) = delete;
+
+    ~StreamingDataset() { close(); }
+
+    bool open(const std::string& path,
+              int batch_size,
+              int depth = 8,
+              size_t chunk_bytes = 4u << 20,
+              bool shuffle_chunks = false,
+              unsigned seed = 0) {
+        close();
+        this->batch_size = batch_size;
+        this->shuffle_chunks = shuffle_chunks;
+        this->seed = seed;
+
+#ifdef _WIN32
+        file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                           OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+        if (file == INVALID_HANDLE_VALUE) {
+            std::cerr << "ERROR: Cannot open " << path << std::endl;
+            return false;
+        }
+#else
+#ifdef O_DIRECT
+        fd = ::open(path.c_str(), O_RDONLY | O_DIRECT);
+        direct_io = fd >= 0;
+        if (fd < 0)   // e.g. tmpfs does not support O_DIRECT
+#endif
+            fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            std::cerr << "ERROR: Cannot open " << path << std::endl;
+            return false;
+        }
+#endif
+
+        StagingBuffer head;
+        head.allocate(IO_ALIGNMENT, IO_ALIGNMENT);
+        if (read_at(head.ptr, IO_ALIGNMENT, 0) < static_cast<long>(sizeof(DatasetHeader))) {
+            std::cerr << "ERROR: " << path << " is too short" << std::endl;
+            close();
+            return false;
+        }
+        std::memcpy(&header, head.ptr, sizeof(header));
+        if (!check_dataset_header(header, path) || !check_dataset_size(header, file_bytes(), path)) {
+            close();
+            return false;
+        }
+
+        // Whole batches per chunk
+        int64_t batches = std::max<int64_t>(1, chunk_bytes / header.record_stride / batch_size);
+        records_per_chunk = batches * batch_size;
+        num_chunks = (size() + records_per_chunk - 1) / records_per_chunk;
+
+        size_t span = static_cast<size_t>(records_per_chunk) * header.record_stride;
+        buffer_bytes = (span + 2 * IO_ALIGNMENT - 1) / IO_ALIGNMENT * IO_ALIGNMENT;
+        ring = std::vector<Slot>(std::max(2, depth));
+        for (auto& slot : ring) slot.buffer.allocate(buffer_bytes, IO_ALIGNMENT);
+
+#ifdef DNN_HAVE_IO_URING
+        use_uring = uring.init(static_cast<unsigned>(ring.size()));
+#endif
+        return true;
+    }
+
+    void close() {
+#ifdef DNN_HAVE_IO_URING
+        drain();
+        uring.close();
+        use_uring = false;
+#endif
+#ifdef _WIN32
+        if (file != INVALID_HANDLE_VALUE) CloseHandle(file);
+        file = INVALID_HANDLE_VALUE;
+#else
+        if (fd >= 0) ::close(fd);
+        fd = -1;
+#endif
+        ring.clear();
+        direct_io = false;
+    }
+
+    int64_t size() const { return static_cast<int64_t>(header.num_records); }
+    int num_features() const override { return static_cast<int>(header.num_features); }
+
+    bool uses_io_uring() const { return use_uring; }
+    bool uses_direct_io() const { return direct_io; }
+
+    bool failed() const override { return io_failed; }
+
+    void start_epoch(int epoch) override {
+#ifdef DNN_HAVE_IO_URING
+        drain();
+        if (uring_unsupported) use_uring = false;
+        if (uring_broken) {
+            // Completions can no longer be reaped: stop using the ring
+            uring.close();
+            use_uring = false;
+            uring_broken = false;
+        }
+#endif
+        io_failed = false;
+        order.resize(num_chunks);
+        std::iota(order.begin(), order.end(), 0);
+        if (shuffle_chunks) {
+            std::mt19937_64 rng(static_cast<uint64_t>(seed) * 1000003u + epoch);
+            std::shuffle(order.begin(), order.end(), rng);
+        }
+
+        for (auto& slot : ring) slot.pos = -1;
+        current = -1;
+        next_submit = 0;
+        batch_in_chunk = 0;
+        chunk_rows = 0;
+
+        if (use_uring) {
+            while (next_submit < num_chunks &&
+                   next_submit < static_cast<int64_t>(ring.size()) &&
+                   submit(next_submit++)) {}
+        }
+    }
+
+    bool next(BatchView& batch) override {
+        if (io_failed) return false;
+        if (batch_in_chunk * batch_size >= chunk_rows) {
+            if (!advance_chunk()) return false;
+        }
+
+        const Slot& slot = ring[current % ring.size()];
+        int64_t first = static_cast<int64_t>(batch_in_chunk) * batch_size;
+
+        batch.features = reinterpret_cast<const float*>(
+            slot.buffer.ptr + slot.offset + first * header.record_stride);
+        batch.labels = reinterpret_cast<const int32_t*>(
+            reinterpret_cast<const char*>(batch.features) + header.label_offset);
+        batch.rows = static_cast<int>(std::min<int64_t>(batch_size, chunk_rows - first));
+        batch.cols = num_features();
+        batch.stride = static_cast<int>(header.record_stride / sizeof(float));
+        batch.label_stride = batch.stride;
+
+        batch_in_chunk++;
+        return true;
+    }
+
+private:
+    struct Slot {
+        StagingBuffer buffer;
+        int64_t pos = -1;      // position in the epoch's chunk order
+        size_t offset = 0;     // first record's offset inside buffer
+        size_t length = 0;     // bytes requested (block aligned)
+        size_t needed = 0;     // bytes that must arrive (offset + records)
+        bool done = false;
+    };
+
+    DatasetHeader header{};
+    int batch_size = 0;
+    bool shuffle_chunks = false;
+    unsigned seed = 0;
+    bool use_uring = false;
+    bool uring_unsupported = false;   // kernel rejected IORING_OP_READ
+    bool uring_broken = false;        // waiting for a completion failed
+    bool direct_io = false;
+    bool io_failed = false;           // this epoch hit a read error
+
+    int64_t records_per_chunk = 0;
+    int64_t num_chunks = 0;
+    size_t buffer_bytes = 0;
+
+    std::vector<Slot> ring;
+    std::vector<int64_t> order;
+    int64_t current = -1;       // position of the chunk being consumed
+    int64_t next_submit = 0;    // next position to queue (io_uring only)
+    int batch_in_chunk = 0;
+    int64_t chunk_rows = 0;
+
+#ifdef _WIN32
+    HANDLE file = INVALID_HANDLE_VALUE;
+#else
+    int fd = -1;
+#endif
+#ifdef DNN_HAVE_IO_URING
+    IoUring uring;
+#endif
+
+    uint64_t file_bytes() const {
+#ifdef _WIN32
+        LARGE_INTEGER size;
+        return GetFileSizeEx(file, &size) ? static_cast<uint64_t>(size.QuadPart) : 0;
+#else
+        struct stat st;
+        return fstat(fd, &st) == 0 ? static_cast<uint64_t>(st.st_size) : 0;
+#endif
+    }
+
+    long read_at(char* dst, size_t len, uint64_t offset) {
+#ifdef _WIN32
+        OVERLAPPED ov;
+        std::memset(&ov, 0, sizeof(ov));
+        ov.Offset = static_cast<DWORD>(offset);
+        ov.OffsetHigh = static_cast<DWORD>(offset >> 32);
+        DWORD got = 0;
+        if (!ReadFile(file, dst, static_cast<DWORD>(len), &got, &ov)) return -1;
+        return static_cast<long>(got);
+#else
+        size_t total = 0;
+        while (total < len) {
+            ssize_t r = pread(fd, dst + total, len - total, offset + total);
+            if (r < 0 && errno == EINTR) continue;
+            if (r <= 0) break;
+            total += static_cast<size_t>(r);
+        }
+        return static_cast<long>(total);
+#endif
+    }
+
+    // Aligned byte range covering chunk `pos` of this epoch
+    void plan(int64_t pos, Slot& slot) {
+        int64_t chunk = order[pos];
+        uint64_t begin = sizeof(DatasetHeader) +
+                         static_cast<uint64_t>(chunk) * records_per_chunk * header.record_stride;
+        int64_t rows = std::min<int64_t>(records_per_chunk, size() - chunk * records_per_chunk);
+        uint64_t end = begin + static_cast<uint64_t>(rows) * header.record_stride;
+
+        uint64_t aligned_begin = begin / IO_ALIGNMENT * IO_ALIGNMENT;
+        uint64_t aligned_end = (end + IO_ALIGNMENT - 1) / IO_ALIGNMENT * IO_ALIGNMENT;
+
+        slot.pos = pos;
+        slot.offset = static_cast<size_t>(begin - aligned_begin);
+        slot.length = static_cast<size_t>(aligned_end - aligned_begin);
+        slot.needed = static_cast<size_t>(end - aligned_begin);
+        slot.done = false;
+    }
+
+    uint64_t slot_file_offset(const Slot& slot) const {
+        int64_t chunk = order[slot.pos];
+        uint64_t begin = sizeof(DatasetHeader) +
+                         static_cast<uint64_t>(chunk) * records_per_chunk * header.record_stride;
+        return begin - slot.offset;
+    }
+
+    // Queue chunk `pos` (or read it now when the ring will not take it)
+    bool submit(int64_t pos) {
+        Slot& slot = ring[pos % ring.size()];
+        plan(pos, slot);
+#ifdef DNN_HAVE_IO_URING
+        if (uring.read(fd, slot.buffer.ptr, static_cast<unsigned>(slot.length),
+                       slot_file_offset(slot), static_cast<uint64_t>(pos)))
+            return true;
+#endif
+        return read_slot(slot);   // submission refused: read synchronously
+    }
+
+    bool read_slot(Slot& slot) {
+        long got = read_at(slot.buffer.ptr, slot.length, slot_file_offset(slot));
+        slot.done = true;
+        if (got < static_cast<long>(slot.needed)) {
+            std::cerr << "ERROR: StreamingDataset read of chunk " << order[slot.pos]
+                      << " failed (" << got << " of " << slot.needed << " bytes)" << std::endl;
+            io_failed = true;
+            return false;
+        }
+        return true;
+    }
+
+#ifdef DNN_HAVE_IO_URING
+    // Reap completions until chunk `pos` has landed
+    bool wait_for(int64_t pos) {
+        Slot& target = ring[pos % ring.size()];
+        while (!target.done) {
+            uint64_t user_data;
+            int res;
+            if (!uring.wait(user_data, res)) {
+                std::cerr << "ERROR: io_uring_enter failed waiting for a read" << std::endl;
+                uring_broken = true;
+                io_failed = true;
+                return false;
+            }
+
+            Slot& slot = ring[user_data % ring.size()];
+            if (res < 0 || static_cast<size_t>(res) < slot.needed) {
+                // Old kernel without IORING_OP_READ, I/O error or a short
+                // read: redo this chunk with pread (the ring is done with
+                // the buffer once its completion is reaped)
+                if (res == -EINVAL || res == -EOPNOTSUPP) uring_unsupported = true;
+                read_slot(slot);
+            }
+            slot.done = true;
+        }
+        return !io_failed;
+    }
+
+    // Wait out reads still in flight before buffers are reused or
+    // freed; their data is discarded, so failures do not matter here
+    void drain() {
+        if (!use_uring) return;
+        for (auto& slot : ring) {
+            while (slot.pos >= 0 && !slot.done) {
+                uint64_t user_data;
+                int res;
+                if (!uring.wait(user_data, res)) {
+                    uring_broken = true;
+                    return;
+                }
+                ring[user_data % ring.size()].done = true;
+            }
+        }
+    }
+#endif
+
+    bool advance_chunk() {
+        int64_t pos = current + 1;
+        if (pos >= num_chunks) return false;
+
+        if (use_uring) {
+            // Previous buffer is free again: keep `depth` reads in flight
+            if (current >= 0 && next_submit < num_chunks && !submit(next_submit++)) return false;
+#ifdef DNN_HAVE_IO_URING
+            if (ring[pos % ring.size()].pos != pos && !submit(pos)) return false;
+            if (!wait_for(pos)) return false;
+#endif
+        } else {
+            Slot& slot = ring[pos % ring.size()];
+            if (slot.pos != pos || !slot.done) {
+                plan(pos, slot);
+                if (!read_slot(slot)) return false;
+            }
+        }
+
+        current = pos;
+        batch_in_chunk = 0;
+        chunk_rows = std::min<int64_t>(records_per_chunk,
+                                       size() - order[pos] * records_per_chunk);
+        return true;
+    }
+};
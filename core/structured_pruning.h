@@ -0,0 +1,136 @@
+#pragma once
+
+#include <vector>
+#include <cmath>
+#include <numeric>
+#include <algorithm>
+#include <cassert>
+
+#include "tensor.h"
+#include "dense_layer.h"
+#include "model.h"
+#include "dataset.h"
+
+/*
+ * Structured (neuron) pruning
+ *
+ * Removing hidden unit j of layer i drops column j of W_i, b_i[j]
+ * and row j of W_{i+1}; the result is a smaller dense model that
+ * runs on the ordinary GEMM path.
+ *
+ * Units are ranked by activation-weighted saliency
+ *   s_j = E|a_j| * ||W_{i+1}(j, :)||_2
+ * (the size of the unit's contribution to the next layer), and each
+ * removed unit's mean activation is folded into the next layer's bias
+ *   b_{i+1} += E[a_j] * W_{i+1}(j, :)
+ * so the next layer sees the expected input instead of zero.
+ */
+struct NeuronStats {
+    std::vector<std::vector<float>> mean;       // E[a_j] per hidden layer
+    std::vector<std::vector<float>> mean_abs;   // E|a_j| per hidden layer
+    std::vector<std::vector<float>> saliency;   // s_j per hidden layer
+};
+
+/*
+ * Activation statistics of every hidden layer (all but the last)
+ * over up to max_batches batches of `data` (all when negative)
+ */
+inline NeuronStats neuron_stats(Model& model, BatchSource& data, int max_batches = -1) {
+    const int H = model.num_layers() - 1;
+    NeuronStats stats;
+    stats.mean.resize(H);
+    stats.mean_abs.resize(H);
+    stats.saliency.resize(H);
+    for (int i = 0; i < H; ++i) {
+        stats.mean[i].assign(model.layer(i).W.cols, 0.0f);
+        stats.mean_abs[i].assign(model.layer(i).W.cols, 0.0f);
+    }
+
+    int64_t seen = 0;
+    BatchView batch;
+    data.start_epoch(0);
+    for (int n = 0; (max_batches < 0 || n < max_batches) && data.next(batch); ++n) {
+        model.predict(batch);
+        // Layer i's output is layer i+1's input
+        for (int i = 0; i < H; ++i) {
+            const DenseLayer& next = model.layer(i + 1);
+            for (int r = 0; r < next.input_rows; ++r) {
+                const float* a = next.input_ptr + static_cast<size_t>(r) * next.input_ld;
+                for (int j = 0; j < next.W.rows; ++j) {
+                    stats.mean[i][j] += a[j];
+                    stats.mean_abs[i][j] += std::fabs(a[j]);
+                }
+            }
+        }
+        seen += batch.rows;
+    }
+
+    for (int i = 0; i < H; ++i) {
+        const Tensor& W_next = model.layer(i + 1).W;
+        stats.saliency[i].resize(W_next.rows);
+        for (int j = 0; j < W_next.rows; ++j) {
+            stats.mean[i][j] /= std::max<int64_t>(seen, 1);
+            stats.mean_abs[i][j] /= std::max<int64_t>(seen, 1);
+            float norm = 0.0f;
+            for (int c = 0; c < W_next.cols; ++c) norm += W_next(j, c) * W_next(j, c);
+            stats.saliency[i][j] = stats.mean_abs[i][j] * std::sqrt(norm);
+        }
+    }
+    return stats;
+}
+
+/*
+ * Build `out` (empty Model) as `src` with hidden widths `widths`
+ * (one per hidden layer), keeping the most salient units of each.
+ * Layers of `out` are owned by it.
+ */
+inline void shrink_model(Model& src, const NeuronStats& stats,
+                         const std::vector<int>& widths, Model& out) {
+    const int L = src.num_layers();
+    assert(out.num_layers() == 0);
+    assert(static_cast<int>(widths.size()) == L - 1);
+
+    // Kept units per hidden layer, in original order
+    std::vector<std::vector<int>> keep(L - 1);
+    for (int i = 0; i < L - 1; ++i) {
+        const std::vector<float>& s = stats.saliency[i];
+        assert(widths[i] >= 1 && widths[i] <= static_cast<int>(s.size()));
+        std::vector<int> order(s.size());
+        std::iota(order.begin(), order.end(), 0);
+        std::stable_sort(order.begin(), order.end(), [&](int a, int b) { return s[a] > s[b]; });
+        keep[i].assign(order.begin(), order.begin() + widths[i]);
+        std::sort(keep[i].begin(), keep[i].end());
+    }
+
+    for (int l = 0; l < L; ++l) {
+        const DenseLayer& s = src.layer(l);
+        const std::vector<int>* rows = l > 0 ? &keep[l - 1] : nullptr;
+        const std::vector<int>* cols = l < L - 1 ? &keep[l] : nullptr;
+        const int in = rows ? static_cast<int>(rows->size()) : s.W.rows;
+        const int outd = cols ? static_cast<int>(cols->size()) : s.W.cols;
+
+        DenseLayer& d = out.add(in, outd, s.activation.type);
+        for (int r = 0; r < in; ++r) {
+            int sr = rows ? (*rows)[r] : r;
+            for (int c = 0; c < outd; ++c)
+                d.W(r, c) = s.W(sr, cols ? (*cols)[c] : c);
+        }
+        for (int c = 0; c < outd; ++c)
+            d.b[c] = s.b[cols ? (*cols)[c] : c];
+
+        // Fold the removed inputs' mean activation into the bias
+        if (rows) {
+            std::vector<bool> kept(s.W.rows, false);
+            for (int r : *rows) kept[r] = true;
+            for (int sr = 0; sr < s.W.rows; ++sr) {
+                if (kept[sr]) continue;
+                const float m = stats.mean[l - 1][sr];
+                for (int c = 0; c < outd; ++c)
+                    d.b[c] += m * s.W(sr, cols ? (*cols)[c] : c);
+            }
+        }
+
+        d.W_param.data = d.W.data;
+        d.b_param.data = d.b;
+    }
+}
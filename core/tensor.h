@@ -1,8 +1,86 @@
 #pragma once
 
 #include <vector>
+#include <algorithm>
 #include <cassert>
 #include <iostream>
+#include <new>
+#include <utility>
+
+#include "tensor_allocator.h"
+
+/*
+ * Tensor storage: a std::vector on TensorAllocator (64-byte aligned,
+ * from the thread's arena inside a TensorArenaScope). Converts to and
+ * from std::vector<float> by copying, for parameter and file code.
+ */
+class TensorData : public std::vector<float, TensorAllocator<float>> {
+public:
+    using Base = std::vector<float, TensorAllocator<float>>;
+    using Base::Base;
+    using Base::operator=;
+
+    TensorData& operator=(const std::vector<float>& v) {
+        assign(v.begin(), v.end());
+        return *this;
+    }
+
+    operator std::vector<float>() const {
+        return std::vector<float>(begin(), end());
+    }
+};
+
+/*
+ * Non-owning view of a 2D block of floats
+ * Element (r, c) is data[r * row_stride + c * col_stride]. Slicing
+ * rows, transposing, reshaping and wrapping rows that live elsewhere
+ * (a dataset batch, a caller's buffer) only make a new view; nothing
+ * is copied, and the floats must outlive the view.
+ */
+struct TensorView {
+    const float* data = nullptr;
+    int rows = 0;
+    int cols = 0;
+    int row_stride = 0;   // in floats
+    int col_stride = 1;
+
+    TensorView() = default;
+
+    TensorView(const float* data_, int rows_, int cols_, int row_stride_, int col_stride_ = 1)
+        : data(data_), rows(rows_), cols(cols_), row_stride(row_stride_), col_stride(col_stride_) {}
+
+    float operator()(int r, int c) const {
+        return data[static_cast<size_t>(r) * row_stride + static_cast<size_t>(c) * col_stride];
+    }
+
+    // Rows [start, start + count)
+    TensorView slice_rows(int start, int count) const {
+        assert(start >= 0 && count >= 0 && start + count <= rows);
+        return TensorView(data + static_cast<size_t>(start) * row_stride, count, cols,
+                          row_stride, col_stride);
+    }
+
+    // (cols x rows) view of the same floats
+    TensorView transposed() const {
+        return TensorView(data, cols, rows, col_stride, row_stride);
+    }
+
+    // Same floats as (r x c), row-major; needs contiguous()
+    TensorView reshaped(int r, int c) const {
+        assert(contiguous() && static_cast<size_t>(r) * c == static_cast<size_t>(rows) * cols);
+        return TensorView(data, r, c, c);
+    }
+
+    // Each row is cols consecutive floats (what the raw-pointer kernels take, with ld = row_stride)
+    bool row_major() const {
+        return col_stride == 1;
+    }
+
+    // One dense block of rows * cols floats
+    bool contiguous() const {
+        return col_stride == 1 && (row_stride == cols || rows <= 1);
+    }
+};
 
 /*
  * Simple 2D Tensor (Matrix) structure
@@ -11,13 +89,17 @@
 struct Tensor {
     int rows;
     int cols;
-    std::vector<float> data;
+    TensorData data;
 
     Tensor() : rows(0), cols(0) {}
 
     Tensor(int r, int c)
         : rows(r), cols(c), data(r * c, 0.0f) {}
 
+    // Storage from a given allocator (e.g. TensorAllocator<float>::heap())
+    Tensor(int r, int c, const TensorAllocator<float>& alloc)
+        : rows(r), cols(c), data(static_cast<size_t>(r) * c, 0.0f, alloc) {}
+
     // Vector-like constructor (for 1D tensors)
     explicit Tensor(int size)
         : rows(1), cols(size), data(size, 0.0f) {}
@@ -41,31 +123,214 @@ struct Tensor {
         return data[i];
     }
 
+    // New shape; reuses the allocation when it is large enough
+    // (contents are unspecified)
+    void resize(int r, int c) {
+        rows = r;
+        cols = c;
+        data.resize(static_cast<size_t>(r) * c);
+    }
+
+    // Empty, with the storage given back
+    void clear() {
+        rows = 0;
+        cols = 0;
+        data.clear();
+        data.shrink_to_fit();
+    }
+
     // Size for vector-like access
     int size() const {
         if (rows == 1) return cols;
         return rows * cols;
     }
+
+    TensorView view() const {
+        return TensorView(data.data(), rows, cols, cols);
+    }
+
+    operator TensorView() const {
+        return view();
+    }
+
+    TensorView slice_rows(int start, int count) const {
+        return view().slice_rows(start, count);
+    }
+
+    // Copy of the elements of v, reusing the allocation when it is
+    // large enough (v must not view this tensor)
+    void assign(const TensorView& v) {
+        resize(v.rows, v.cols);
+        for (int i = 0; i < v.rows; ++i) {
+            float* dst = data.data() + static_cast<size_t>(i) * v.cols;
+            if (v.row_major()) {
+                std::copy_n(v.data + static_cast<size_t>(i) * v.row_stride, v.cols, dst);
+            } else {
+                for (int j = 0; j < v.cols; ++j) dst[j] = v(i, j);
+            }
+        }
+    }
+
+    // Take over other's storage together with its allocator (a move
+    // assignment keeps this tensor's allocator, and so copies the
+    // elements when the two differ)
+    void adopt(Tensor&& other) {
+        if (&other == this) return;
+        rows = other.rows;
+        cols = other.cols;
+        data.~TensorData();
+        new (&data) TensorData(std::move(other.data));
+        other.rows = 0;
+        other.cols = 0;
+    }
 };
 
+/*
+ * Owning (row-major) copy of a view
+ */
+inline Tensor to_tensor(const TensorView& A) {
+    Tensor C;
+    C.assign(A);
+    return C;
+}
+
+/*
+ * Copy of A on the heap, for results leaving a TensorArenaScope
+ */
+inline Tensor heap_copy(const TensorView& A) {
+    Tensor C(0, 0, TensorAllocator<float>::heap());
+    C.assign(A);
+    return C;
+}
+
+/*
+ * Row-major GEMM on raw pointers: C = A * B
+ * A: (m x k), row stride lda (in floats)
+ * B: (k x n), contiguous
+ * C: (m x n), contiguous, overwritten
+ *
+ * Lets callers multiply rows that live outside a Tensor
+ * (e.g. a memory-mapped dataset batch) without copying them.
+ */
+inline void gemm(const float* A, int m, int k, int lda,
+                 const float* B, int n, float* C) {
+    for (int i = 0; i < m; ++i) {
+        float* c_row = C + static_cast<size_t>(i) * n;
+        for (int j = 0; j < n; ++j) c_row[j] = 0.0f;
+
+        const float* a_row = A + static_cast<size_t>(i) * lda;
+        for (int p = 0; p < k; ++p) {
+            const float a = a_row[p];
+            const float* b_row = B + static_cast<size_t>(p) * n;
+            for (int j = 0; j < n; ++j) {
+                c_row[j] += a * b_row[j];
+            }
+        }
+    }
+}
+
+/*
+ * Transposed-A GEMM on raw pointers: C = A^T * B
+ * A: (m x k), row stride lda (in floats)
+ * B: (m x n), contiguous
+ * C: (k x n), contiguous, overwritten
+ *
+ * Used for dW = X^T * dOut without materialising X^T.
+ */
+inline void gemm_tn(const float* A, int m, int k, int lda,
+                    const float* B, int n, float* C) {
+    for (size_t i = 0; i < static_cast<size_t>(k) * n; ++i) C[i] = 0.0f;
+
+    for (int i = 0; i < m; ++i) {
+        const float* a_row = A + static_cast<size_t>(i) * lda;
+        const float* b_row = B + static_cast<size_t>(i) * n;
+        for (int p = 0; p < k; ++p) {
+            const float a = a_row[p];
+            float* c_row = C + static_cast<size_t>(p) * n;
+            for (int j = 0; j < n; ++j) {
+                c_row[j] += a * b_row[j];
+            }
+        }
+    }
+}
+
+/*
+ * Transposed-B GEMM on raw pointers: C = A * B^T
+ * A: (m x n), contiguous
+ * B: (k x n), contiguous
+ * C: (m x k), contiguous, overwritten
+ *
+ * Used for dX = dOut * W^T without materialising W^T.
+ *
+ * Each output is a dot product of two rows. A single running sum is a
+ * serial dependency the compiler may not reorder, so every dot keeps
+ * GEMM_NT_LANES partial sums (one vector register), and R rows of B
+ * share each load of the A row.
+ */
+static const int GEMM_NT_LANES = 8;
+
+template <int R>
+inline void gemm_nt_dots(const float* a_row, const float* B, int n, float* out) {
+    float acc[R][GEMM_NT_LANES] = {};
+    int j = 0;
+    for (; j + GEMM_NT_LANES <= n; j += GEMM_NT_LANES) {
+        for (int r = 0; r < R; ++r) {
+            const float* b_row = B + static_cast<size_t>(r) * n + j;
+            for (int l = 0; l < GEMM_NT_LANES; ++l) acc[r][l] += a_row[j + l] * b_row[l];
+        }
+    }
+    for (int r = 0; r < R; ++r) {
+        const float* b_row = B + static_cast<size_t>(r) * n;
+        float sum = 0.0f;
+        for (int l = 0; l < GEMM_NT_LANES; ++l) sum += acc[r][l];
+        for (int jj = j; jj < n; ++jj) sum += a_row[jj] * b_row[jj];
+        out[r] = sum;
+    }
+}
+
+inline void gemm_nt(const float* A, int m, int n,
+                    const float* B, int k, float* C) {
+    for (int i = 0; i < m; ++i) {
+        const float* a_row = A + static_cast<size_t>(i) * n;
+        float* c_row = C + static_cast<size_t>(i) * k;
+        int p = 0;
+        for (; p + 4 <= k; p += 4)
+            gemm_nt_dots<4>(a_row, B + static_cast<size_t>(p) * n, n, c_row + p);
+        for (; p < k; ++p)
+            gemm_nt_dots<1>(a_row, B + static_cast<size_t>(p) * n, n, c_row + p);
+    }
+}
+
 /*
  * Matrix multiplication: C = A * B
  * A: (m x n)
  * B: (n x p)
  * C: (m x p)
+ *
+ * Views are read in place: a row-major A goes to gemm, a transposed
+ * view of a row-major matrix as A to gemm_tn and as B to gemm_nt,
+ * with no transpose materialised. Other strides take a plain loop.
  */
-inline Tensor matmul(const Tensor& A, const Tensor& B) {
+inline Tensor matmul(const TensorView& A, const TensorView& B) {
     assert(A.cols == B.rows);
 
-    Tensor C(A.rows, B.cols);
-
-    for (int i = 0; i < A.rows; ++i) {
-        for (int j = 0; j < B.cols; ++j) {
-            float sum = 0.0f;
-            for (int k = 0; k < A.cols; ++k) {
-                sum += A(i, k) * B(k, j);
+    const int m = A.rows, k = A.cols, n = B.cols;
+    Tensor C(m, n);
+    if (A.row_major() && B.contiguous()) {
+        gemm(A.data, m, k, A.row_stride, B.data, n, C.data.data());
+    } else if (A.transposed().row_major() && B.contiguous()) {
+        // A = X^T, X: (k x m), row stride A.col_stride
+        gemm_tn(A.data, k, m, A.col_stride, B.data, n, C.data.data());
+    } else if (A.contiguous() && B.transposed().contiguous()) {
+        // B = Y^T, Y: (n x k) contiguous
+        gemm_nt(A.data, m, k, B.data, n, C.data.data());
+    } else {
+        for (int i = 0; i < m; ++i) {
+            for (int j = 0; j < n; ++j) {
+                float sum = 0.0f;
+                for (int p = 0; p < k; ++p) sum += A(i, p) * B(p, j);
+                C(i, j) = sum;
             }
-            C(i, j) = sum;
         }
     }
     return C;
@@ -76,33 +341,32 @@ inline Tensor matmul(const Tensor& A, const Tensor& B) {
  * A: (batch x features)
  * b: (features)
  */
-inline void add_bias(Tensor& A, const std::vector<float>& b) {
-    assert(A.cols == static_cast<int>(b.size()));
+inline void add_bias(float* A, int rows, int cols, const std::vector<float>& b) {
+    assert(cols == static_cast<int>(b.size()));
 
-    for (int i = 0; i < A.rows; ++i) {
-        for (int j = 0; j < A.cols; ++j) {
-            A(i, j) += b[j];
+    for (int i = 0; i < rows; ++i) {
+        float* a = A + static_cast<size_t>(i) * cols;
+        for (int j = 0; j < cols; ++j) {
+            a[j] += b[j];
         }
     }
 }
 
+inline void add_bias(Tensor& A, const std::vector<float>& b) {
+    add_bias(A.data.data(), A.rows, A.cols, b);
+}
+
 /*
  * Transpose of a matrix
  */
-inline Tensor transpose(const Tensor& A) {
-    Tensor T(A.cols, A.rows);
-    for (int i = 0; i < A.rows; ++i) {
-        for (int j = 0; j < A.cols; ++j) {
-            T(j, i) = A(i, j);
-        }
-    }
-    return T;
+inline Tensor transpose(const TensorView& A) {
+    return to_tensor(A.transposed());
 }
 
 /*
  * Print tensor (for debugging / verification)
  */
-inline void print_tensor(const Tensor& A, const std::string& name = "") {
+inline void print_tensor(const TensorView& A, const std::string& name = "") {
     if (!name.empty()) {
         std::cout << name << ":\n";
     }
@@ -117,7 +381,7 @@ inline void print_tensor(const Tensor& A, const std::string& name = "") {
 /*
  * Find index of maximum value in tensor (for classification)
  */
-inline int argmax(const Tensor& A) {
+inline int argmax(const TensorView& A) {
     int max_idx = 0;
     float max_val = A(0, 0);
     for (int i = 0; i < A.rows; ++i) {
@@ -135,3 +399,18 @@ inline int argmax(const Tensor& A) {
     // For 2D tensors, return column index of first row (typical for batch_size=1)
     return max_idx % A.cols;
 }
+
+/*
+ * Column index of maximum value in row r (batched classification)
+ */
+inline int argmax_row(const TensorView& A, int r) {
+    int max_idx = 0;
+    float max_val = A(r, 0);
+    for (int j = 1; j < A.cols; ++j) {
+        if (A(r, j) > max_val) {
+            max_val = A(r, j);
+            max_idx = j;
+        }
+    }
+    return max_idx;
+}
@@ -0,0 +1,257 @@
+#pragma once
+
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <algorithm>
+#include <type_traits>
+#include <cassert>
+#include <iostream>
+
+/*
+ * Tensor storage allocation
+ *
+ * Tensor data goes through TensorAllocator, which forwards to a
+ * TensorMemory chosen when the tensor is created: the calling thread's
+ * current memory, normally the heap. Inside a TensorArenaScope it is
+ * the thread's TensorArena, a bump allocator that is reset when the
+ * outermost scope on that thread ends. Model::predict / fit /
+ * evaluate open one per call / step, so the temporaries of a step
+ * (GEMM outputs, transposes, activation outputs) come from memory the
+ * thread already owns: no malloc, no lock, no fresh pages once warm.
+ *
+ * Arena memory must not outlive its scope. Copies and assignments
+ * never move arena storage into an existing tensor (the allocator does
+ * not propagate), so layer caches and other members keep their own
+ * heap storage; values returned out of a scope go through
+ * TensorAllocator<float>::heap() (see Model::predict). TensorArena
+ * counts live allocations and refuses to reset while any remain.
+ *
+ * Other memory can be plugged in by pointing current_tensor_memory()
+ * at a TensorMemory. All blocks are ALIGNMENT-byte aligned.
+ */
+class TensorMemory {
+public:
+    static constexpr size_t ALIGNMENT = 64;
+
+    virtual void* allocate(size_t bytes) = 0;
+    virtual void deallocate(void* p, size_t bytes) = 0;
+    virtual ~TensorMemory() = default;
+};
+
+class HeapTensorMemory : public TensorMemory {
+public:
+    void* allocate(size_t bytes) override {
+        return ::operator new(bytes, std::align_val_t(ALIGNMENT));
+    }
+
+    void deallocate(void* p, size_t) override {
+        ::operator delete(p, std::align_val_t(ALIGNMENT));
+    }
+};
+
+inline TensorMemory& heap_tensor_memory() {
+    static HeapTensorMemory heap;
+    return heap;
+}
+
+/*
+ * Bump allocator over a list of chunks
+ * allocate() takes the next aligned block of the current chunk (or
+ * the next chunk large enough); deallocate() only gives memory back
+ * when it is the most recent block. reset() makes everything free
+ * again, first merging the chunks into one so a steady workload runs
+ * from a single block.
+ */
+class TensorArena : public TensorMemory {
+public:
+    explicit TensorArena(size_t chunk_bytes_ = 1 << 20) : chunk_bytes(chunk_bytes_) {}
+
+    TensorArena(const TensorArena&) = delete;
+    TensorArena& operator=(const TensorArena&) = delete;
+
+    ~TensorArena() override {
+        for (Chunk& c : chunks) free_chunk(c);
+    }
+
+    void* allocate(size_t bytes) override {
+        bytes = round_up(bytes);
+        while (current < chunks.size() && offset + bytes > chunks[current].size) {
+            current++;
+            offset = 0;
+        }
+        if (current == chunks.size()) {
+            const size_t last = chunks.empty() ? 0 : chunks.back().size;
+            size_t size = std::max(chunk_bytes, 2 * last);
+            while (size < bytes) size *= 2;
+            chunks.push_back(new_chunk(size));
+            offset = 0;
+        }
+
+        char* p = chunks[current].base + offset;
+        offset += bytes;
+        used += bytes;
+        high_water = std::max(high_water, used);
+        live++;
+        return p;
+    }
+
+    void deallocate(void* p, size_t bytes) override {
+        assert(live > 0);
+        live--;
+        bytes = round_up(bytes);
+        if (current < chunks.size() && static_cast<char*>(p) + bytes == chunks[current].base + offset) {
+            offset -= bytes;
+            used -= bytes;
+        }
+    }
+
+    /*
+     * Make all memory free again. Refused (returns false, nothing is
+     * handed out twice) while allocations are still live: they
+     * outlived their scope.
+     */
+    bool reset() {
+        if (live != 0) {
+            std::cerr << "ERROR: tensor arena memory outlived its scope (" << live
+                      << " live allocations), not reset\n";
+            return false;
+        }
+        if (chunks.size() > 1) {
+            size_t total = 0;
+            for (Chunk& c : chunks) {
+                total += c.size;
+                free_chunk(c);
+            }
+            chunks.clear();
+            chunks.push_back(new_chunk(total));
+        }
+        current = 0;
+        offset = 0;
+        used = 0;
+        return true;
+    }
+
+    // Bytes reserved from the system
+    size_t capacity() const {
+        size_t total = 0;
+        for (const Chunk& c : chunks) total += c.size;
+        return total;
+    }
+
+    // Most bytes in use at once since construction
+    size_t peak() const {
+        return high_water;
+    }
+
+    int depth = 0;   // open TensorArenaScopes on this arena
+
+private:
+    struct Chunk {
+        char* base;
+        size_t size;
+    };
+
+    std::vector<Chunk> chunks;
+    size_t chunk_bytes;
+    size_t current = 0;   // chunk being bumped
+    size_t offset = 0;    // into chunks[current]
+    size_t used = 0;
+    size_t high_water = 0;
+    int64_t live = 0;
+
+    static size_t round_up(size_t bytes) {
+        return (bytes + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
+    }
+
+    static Chunk new_chunk(size_t size) {
+        return { static_cast<char*>(::operator new(size, std::align_val_t(ALIGNMENT))), size };
+    }
+
+    static void free_chunk(Chunk& c) {
+        ::operator delete(c.base, std::align_val_t(ALIGNMENT));
+    }
+};
+
+// This thread's arena
+inline TensorArena& thread_tensor_arena() {
+    thread_local TensorArena arena;
+    return arena;
+}
+
+// Memory new tensors on this thread are allocated from
+inline TensorMemory*& current_tensor_memory() {
+    thread_local TensorMemory* current = &heap_tensor_memory();
+    return current;
+}
+
+/*
+ * std::vector allocator over a TensorMemory
+ * Default-constructed (and on container copy) it takes the thread's
+ * current memory; it never propagates on assignment or swap.
+ */
+template <typename T>
+class TensorAllocator {
+public:
+    using value_type = T;
+    using propagate_on_container_copy_assignment = std::false_type;
+    using propagate_on_container_move_assignment = std::false_type;
+    using propagate_on_container_swap = std::false_type;
+
+    TensorMemory* memory;
+
+    TensorAllocator() noexcept : memory(current_tensor_memory()) {}
+
+    explicit TensorAllocator(TensorMemory& m) noexcept : memory(&m) {}
+
+    template <typename U>
+    TensorAllocator(const TensorAllocator<U>& other) noexcept : memory(other.memory) {}
+
+    // Heap storage regardless of any open arena scope
+    static TensorAllocator heap() {
+        return TensorAllocator(heap_tensor_memory());
+    }
+
+    T* allocate(size_t n) {
+        return static_cast<T*>(memory->allocate(n * sizeof(T)));
+    }
+
+    void deallocate(T* p, size_t n) {
+        memory->deallocate(p, n * sizeof(T));
+    }
+
+    TensorAllocator select_on_container_copy_construction() const {
+        return TensorAllocator();
+    }
+
+    template <typename U>
+    bool operator==(const TensorAllocator<U>& other) const { return memory == other.memory; }
+
+    template <typename U>
+    bool operator!=(const TensorAllocator<U>& other) const { return memory != other.memory; }
+};
+
+/*
+ * Routes this thread's new tensors to its arena for the scope's
+ * lifetime; the arena is reset when the outermost scope closes
+ */
+class TensorArenaScope {
+public:
+    TensorArenaScope() : arena(thread_tensor_arena()), previous(current_tensor_memory()) {
+        arena.depth++;
+        current_tensor_memory() = &arena;
+    }
+
+    ~TensorArenaScope() {
+        current_tensor_memory() = previous;
+        if (--arena.depth == 0) arena.reset();
+    }
+
+    TensorArenaScope(const TensorArenaScope&) = delete;
+    TensorArenaScope& operator=(const TensorArenaScope&) = delete;
+
+private:
+    TensorArena& arena;
+    TensorMemory* previous;
+};
@@ -0,0 +1,210 @@
+#pragma once
+
+#include <vector>
+#include <cmath>
+#include <cstdint>
+#include <algorithm>
+#include <cassert>
+
+#include "tensor.h"
+#include "dense_layer.h"
+#include "model.h"
+
+#if defined(__AVX2__) && defined(__FMA__)
+#include <immintrin.h>
+#define DNN_CODEBOOK_AVX2 1
+#endif
+
+/*
+ * Weight clustering (codebook quantization)
+ *
+ * Each layer's weights are clustered into 16 or 256 centroids by
+ * 1-D k-means; W stores a 4- or 8-bit centroid index per entry.
+ *
+ * Inference is a lookup-table GEMV: for every input x_k the
+ * products x_k * centroid[c] are computed once (16 / 256 multiplies)
+ * and each output gathers its term by index:
+ *   out_j = sum_k lut_k[idx(k, j)]
+ * 16 centroids: the table fits two registers, gathered with vpermps
+ *               and a blend on index bit 3.
+ * 256 centroids: building a 256-entry table per input would cost
+ *               more multiplies than it saves, so the kernel gathers
+ *               the centroids themselves (vgatherdps, 1 KB in L1)
+ *               and multiplies by x_k with an FMA.
+ *
+ * Layout: index row k is N padded to a multiple of 8; 4-bit indices
+ * pack 8 columns per uint32 (nibble t = column 8jb + t).
+ */
+
+/*
+ * 1-D k-means (Lloyd): `k` centroids (ascending) for `values`,
+ * initialised evenly over [min, max] so the tails get centroids too
+ */
+inline std::vector<float> kmeans_1d(std::vector<float> values, int k, int iterations = 300) {
+    assert(!values.empty() && k >= 1);
+    std::sort(values.begin(), values.end());
+    const size_t n = values.size();
+
+    // With sorted values each cluster is a contiguous run, so its mean
+    // comes from prefix sums and an iteration costs O(k log n)
+    std::vector<double> prefix(n + 1, 0.0);
+    for (size_t i = 0; i < n; ++i) prefix[i + 1] = prefix[i] + values[i];
+
+    std::vector<float> centroids(k);
+    const float lo = values.front(), hi = values.back();
+    for (int c = 0; c < k; ++c)
+        centroids[c] = lo + (hi - lo) * (c + 0.5f) / k;
+
+    std::vector<size_t> bounds(k + 1);
+    for (int it = 0; it < iterations; ++it) {
+        bounds[0] = 0;
+        bounds[k] = n;
+        for (int c = 1; c < k; ++c) {
+            float mid = 0.5f * (centroids[c - 1] + centroids[c]);
+            bounds[c] = std::lower_bound(values.begin(), values.end(), mid) - values.begin();
+            bounds[c] = std::max(bounds[c], bounds[c - 1]);
+        }
+
+        bool moved = false;
+        for (int c = 0; c < k; ++c) {
+            if (bounds[c] == bounds[c + 1]) continue;   // empty: keep position
+            float mean = static_cast<float>((prefix[bounds[c + 1]] - prefix[bounds[c]]) /
+                                            (bounds[c + 1] - bounds[c]));
+            if (mean != centroids[c]) moved = true;
+            centroids[c] = mean;
+        }
+        std::sort(centroids.begin(), centroids.end());
+        if (!moved) break;
+    }
+    return centroids;
+}
+
+class CodebookWeights : public PackedWeights {
+public:
+    // centroids: 16 (4-bit indices) or 256 (8-bit indices)
+    CodebookWeights(const Tensor& W, int centroids)
+        : K(W.rows),
+          N(W.cols),
+          Np((W.cols + 7) / 8 * 8),
+          bits(centroids == 16 ? 4 : 8),
+          codebook(kmeans_1d(W.data, centroids)) {
+        assert(centroids == 16 || centroids == 256);
+
+        if (bits == 4)
+            idx4.assign(static_cast<size_t>(K) * (Np / 8), 0);
+        else
+            idx8.assign(static_cast<size_t>(K) * Np, 0);
+
+        for (int k = 0; k < K; ++k) {
+            for (int j = 0; j < N; ++j) {
+                uint32_t c = nearest(W(k, j));
+                if (bits == 4)
+                    idx4[static_cast<size_t>(k) * (Np / 8) + j / 8] |= c << (4 * (j % 8));
+                else
+                    idx8[static_cast<size_t>(k) * Np + j] = static_cast<uint8_t>(c);
+            }
+        }
+    }
+
+    void multiply(const float* X, int rows, int ld, float* out) const override {
+        thread_local std::vector<float> acc;
+        float lut[16];
+        acc.resize(Np);
+
+        for (int i = 0; i < rows; ++i) {
+            const float* x = X + static_cast<size_t>(i) * ld;
+            std::fill(acc.begin(), acc.end(), 0.0f);
+
+            for (int k = 0; k < K; ++k) {
+                const float xk = x[k];
+                if (xk == 0.0f) continue;
+
+                if (bits == 4) {
+                    for (int c = 0; c < 16; ++c) lut[c] = xk * codebook[c];
+                    gather4(lut, &idx4[static_cast<size_t>(k) * (Np / 8)], acc.data());
+                } else {
+                    gather8(xk, &idx8[static_cast<size_t>(k) * Np], acc.data());
+                }
+            }
+            std::copy(acc.begin(), acc.begin() + N, out + static_cast<size_t>(i) * N);
+        }
+    }
+
+    size_t bytes() const override {
+        return idx4.size() * sizeof(uint32_t) + idx8.size() + codebook.size() * sizeof(float);
+    }
+
+    const std::vector<float>& centroids() const { return codebook; }
+
+    int index(int k, int j) const {
+        if (bits == 4)
+            return (idx4[static_cast<size_t>(k) * (Np / 8) + j / 8] >> (4 * (j % 8))) & 0xF;
+        return idx8[static_cast<size_t>(k) * Np + j];
+    }
+
+private:
+    int K;
+    int N;
+    int Np;
+    int bits;
+    std::vector<float> codebook;     // ascending
+    std::vector<uint32_t> idx4;      // (K x Np/8), 16 centroids
+    std::vector<uint8_t> idx8;       // (K x Np), 256 centroids
+
+    uint32_t nearest(float w) const {
+        auto it = std::lower_bound(codebook.begin(), codebook.end(), w);
+        size_t c = it - codebook.begin();
+        if (c == codebook.size() || (c > 0 && w - codebook[c - 1] < codebook[c] - w)) c--;
+        return static_cast<uint32_t>(c);
+    }
+
+    // acc[0..Np) += lut[idx] for one row of 4-bit indices
+    void gather4(const float* lut, const uint32_t* row, float* acc) const {
+#ifdef DNN_CODEBOOK_AVX2
+        const __m256 lo = _mm256_loadu_ps(lut);
+        const __m256 hi = _mm256_loadu_ps(lut + 8);
+        const __m256i shifts = _mm256_setr_epi32(0, 4, 8, 12, 16, 20, 24, 28);
+        const __m256i nibble = _mm256_set1_epi32(0xF);
+        for (int jb = 0; jb < Np / 8; ++jb) {
+            __m256i idx = _mm256_and_si256(
+                _mm256_srlv_epi32(_mm256_set1_epi32(static_cast<int>(row[jb])), shifts), nibble);
+            // vpermps uses idx & 7; bit 3 (moved to the sign bit) picks the half
+            __m256 v = _mm256_blendv_ps(_mm256_permutevar8x32_ps(lo, idx),
+                                        _mm256_permutevar8x32_ps(hi, idx),
+                                        _mm256_castsi256_ps(_mm256_slli_epi32(idx, 28)));
+            float* a = acc + jb * 8;
+            _mm256_storeu_ps(a, _mm256_add_ps(_mm256_loadu_ps(a), v));
+        }
+#else
+        for (int jb = 0; jb < Np / 8; ++jb) {
+            uint32_t word = row[jb];
+            for (int t = 0; t < 8; ++t) acc[jb * 8 + t] += lut[(word >> (4 * t)) & 0xF];
+        }
+#endif
+    }
+
+    // acc[0..Np) += xk * codebook[idx] for one row of 8-bit indices
+    void gather8(float xk, const uint8_t* row, float* acc) const {
+#ifdef DNN_CODEBOOK_AVX2
+        const __m256 xv = _mm256_set1_ps(xk);
+        for (int j = 0; j < Np; j += 8) {
+            __m256i idx = _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(row + j)));
+            __m256 w = _mm256_i32gather_ps(codebook.data(), idx, 4);
+            _mm256_storeu_ps(acc + j, _mm256_fmadd_ps(xv, w, _mm256_loadu_ps(acc + j)));
+        }
+#else
+        for (int j = 0; j < Np; ++j) acc[j] += xk * codebook[row[j]];
+#endif
+    }
+};
+
+/*
+ * Run every layer through a `centroids`-entry codebook (16 or 256)
+ */
+inline void set_codebook_weights(Model& model, int centroids) {
+    for (int l = 0; l < model.num_layers(); ++l) {
+        DenseLayer& layer = model.layer(l);
+        assert(layer.has_fp32_weights() && "W was freed by release_for_inference");
+        layer.packed.reset(new CodebookWeights(layer.W, centroids));
+    }
+}
@@ -0,0 +1,298 @@
+#pragma once
+
+#include <vector>
+#include <string>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+#include <cassert>
+
+#include "tensor.h"
+#include "dense_layer.h"
+#include "model.h"
+#include "half.h"
+
+#if defined(__AVX2__) && defined(__FMA__)
+#include <immintrin.h>
+#define DNN_WEIGHT_ONLY_AVX2 1
+#endif
+
+/*
+ * Dynamic (weight-only) quantization
+ *
+ * W is stored as int8 or int4 with one symmetric scale per output
+ * column; activations stay fp32, so no calibration data is needed.
+ * The kernel widens weights to fp32 in registers and factors the
+ * column scale out of the dot product:
+ *   out(i, j) = scale[j] * sum_k X(i, k) * q(k, j)
+ *
+ * Layout is row-major in k (the order X * W streams W), N padded to
+ * a multiple of 8. int4 packs 8 columns into one uint32, nibble t
+ * holding q(k, 8jb + t) + 8.
+ *
+ * FP16 / BF16 keep W as 16-bit floats instead (HalfWeights below).
+ */
+enum class WeightStorage {
+    FP32,
+    FP16,
+    BF16,
+    INT8,
+    INT4
+};
+
+inline bool parse_weight_storage(const std::string& name, WeightStorage& storage) {
+    if (name == "fp32") storage = WeightStorage::FP32;
+    else if (name == "fp16") storage = WeightStorage::FP16;
+    else if (name == "bf16") storage = WeightStorage::BF16;
+    else if (name == "int8") storage = WeightStorage::INT8;
+    else if (name == "int4") storage = WeightStorage::INT4;
+    else return false;
+    return true;
+}
+
+class WeightOnlyWeights : public PackedWeights {
+public:
+    WeightOnlyWeights(const Tensor& W, WeightStorage storage)
+        : storage(storage),
+          K(W.rows),
+          N(W.cols),
+          Np((W.cols + 7) / 8 * 8),
+          scales(Np, 0.0f) {
+        assert(storage == WeightStorage::INT8 || storage == WeightStorage::INT4);
+
+        const int qmax = storage == WeightStorage::INT8 ? 127 : 7;
+        for (int j = 0; j < N; ++j) {
+            float max_abs = 0.0f;
+            for (int k = 0; k < K; ++k)
+                max_abs = std::max(max_abs, std::fabs(W(k, j)));
+            scales[j] = max_abs > 0.0f ? max_abs / qmax : 1.0f;
+        }
+
+        if (storage == WeightStorage::INT8)
+            q8.assign(static_cast<size_t>(K) * Np, 0);
+        else
+            q4.assign(static_cast<size_t>(K) * (Np / 8), 0x88888888u);   // all zeros
+
+        for (int k = 0; k < K; ++k) {
+            for (int j = 0; j < N; ++j) {
+                int q = static_cast<int>(std::lround(W(k, j) / scales[j]));
+                q = std::min(std::max(q, -qmax), qmax);
+                if (storage == WeightStorage::INT8) {
+                    q8[static_cast<size_t>(k) * Np + j] = static_cast<int8_t>(q);
+                } else {
+                    uint32_t& word = q4[static_cast<size_t>(k) * (Np / 8) + j / 8];
+                    int shift = 4 * (j % 8);
+                    word = (word & ~(0xFu << shift)) | (static_cast<uint32_t>(q + 8) << shift);
+                }
+            }
+        }
+    }
+
+    void multiply(const float* X, int rows, int ld, float* out) const override {
+        thread_local std::vector<float> acc;
+        acc.resize(Np);
+
+        for (int i = 0; i < rows; ++i) {
+            const float* x = X + static_cast<size_t>(i) * ld;
+            std::fill(acc.begin(), acc.end(), 0.0f);
+
+            if (storage == WeightStorage::INT8)
+                gemv_int8(x, acc.data());
+            else
+                gemv_int4(x, acc.data());
+
+            float* y = out + static_cast<size_t>(i) * N;
+            for (int j = 0; j < N; ++j) y[j] = acc[j] * scales[j];
+        }
+    }
+
+    size_t bytes() const override {
+        return q8.size() + q4.size() * sizeof(uint32_t) + scales.size() * sizeof(float);
+    }
+
+private:
+    WeightStorage storage;
+    int K;
+    int N;
+    int Np;
+    std::vector<float> scales;
+    std::vector<int8_t> q8;     // (K x Np)
+    std::vector<uint32_t> q4;   // (K x Np/8)
+
+    void gemv_int8(const float* x, float* acc) const {
+        for (int k = 0; k < K; ++k) {
+            const int8_t* row = q8.data() + static_cast<size_t>(k) * Np;
+#ifdef DNN_WEIGHT_ONLY_AVX2
+            const __m256 xk = _mm256_set1_ps(x[k]);
+            for (int j = 0; j < Np; j += 8) {
+                __m128i b8 = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(row + j));
+                __m256 w = _mm256_cvtepi32_ps(_mm256_cvtepi8_epi32(b8));
+                _mm256_storeu_ps(acc + j, _mm256_fmadd_ps(xk, w, _mm256_loadu_ps(acc + j)));
+            }
+#else
+            const float xk = x[k];
+            for (int j = 0; j < Np; ++j) acc[j] += xk * static_cast<float>(row[j]);
+#endif
+        }
+    }
+
+    void gemv_int4(const float* x, float* acc) const {
+        const int words = Np / 8;
+#ifdef DNN_WEIGHT_ONLY_AVX2
+        const __m256i shifts = _mm256_setr_epi32(0, 4, 8, 12, 16, 20, 24, 28);
+        const __m256i nibble = _mm256_set1_epi32(0xF);
+        const __m256i bias = _mm256_set1_epi32(8);
+#endif
+        for (int k = 0; k < K; ++k) {
+            const uint32_t* row = q4.data() + static_cast<size_t>(k) * words;
+#ifdef DNN_WEIGHT_ONLY_AVX2
+            const __m256 xk = _mm256_set1_ps(x[k]);
+            for (int jb = 0; jb < words; ++jb) {
+                __m256i v = _mm256_set1_epi32(static_cast<int>(row[jb]));
+                v = _mm256_sub_epi32(_mm256_and_si256(_mm256_srlv_epi32(v, shifts), nibble), bias);
+                __m256 w = _mm256_cvtepi32_ps(v);
+                float* a = acc + jb * 8;
+                _mm256_storeu_ps(a, _mm256_fmadd_ps(xk, w, _mm256_loadu_ps(a)));
+            }
+#else
+            const float xk = x[k];
+            for (int jb = 0; jb < words; ++jb) {
+                uint32_t word = row[jb];
+                float* a = acc + jb * 8;
+                for (int t = 0; t < 8; ++t)
+                    a[t] += xk * static_cast<float>(static_cast<int>((word >> (4 * t)) & 0xF) - 8);
+            }
+#endif
+        }
+    }
+};
+
+/*
+ * 16-bit float weights
+ *
+ *   FP16: fp16 W (K x Np), fp32 activations; F16C widens 8 weights
+ *         per load and the dot product runs in fp32.
+ *   BF16: bf16 W and bf16-rounded activations, fp32 accumulation.
+ *         W is stored as k-pairs, packed[(kp * Np + j) * 2 + t] =
+ *         W(2kp + t, j), the operand layout of vdpbf16ps; without
+ *         AVX-512 BF16 the pairs are widened to fp32 with shifts
+ *         (the same products, so every build gives ~equal outputs).
+ */
+class HalfWeights : public PackedWeights {
+public:
+    HalfWeights(const Tensor& W, WeightStorage storage)
+        : storage(storage),
+          K(W.rows),
+          N(W.cols),
+          Np((W.cols + 7) / 8 * 8),
+          KP((W.rows + 1) / 2) {
+        assert(storage == WeightStorage::FP16 || storage == WeightStorage::BF16);
+
+        if (storage == WeightStorage::FP16) {
+            w16.assign(static_cast<size_t>(K) * Np, 0);
+            for (int k = 0; k < K; ++k)
+                float_to_half(&W.data[static_cast<size_t>(k) * N],
+                              &w16[static_cast<size_t>(k) * Np], N);
+        } else {
+            w16.assign(static_cast<size_t>(KP) * Np * 2, 0);
+            for (int k = 0; k < K; ++k)
+                for (int j = 0; j < N; ++j)
+                    w16[(static_cast<size_t>(k / 2) * Np + j) * 2 + k % 2] = float_to_bf16(W(k, j));
+        }
+    }
+
+    void multiply(const float* X, int rows, int ld, float* out) const override {
+        thread_local std::vector<float> acc;
+        thread_local std::vector<bf16_t> xb;
+        acc.resize(Np);
+        xb.assign(static_cast<size_t>(KP) * 2, 0);
+
+        for (int i = 0; i < rows; ++i) {
+            const float* x = X + static_cast<size_t>(i) * ld;
+            std::fill(acc.begin(), acc.end(), 0.0f);
+
+            if (storage == WeightStorage::FP16) {
+                gemv_fp16(x, acc.data());
+            } else {
+                float_to_bf16(x, xb.data(), K);
+                gemv_bf16(xb.data(), acc.data());
+            }
+            std::memcpy(out + static_cast<size_t>(i) * N, acc.data(), N * sizeof(float));
+        }
+    }
+
+    size_t bytes() const override { return w16.size() * sizeof(uint16_t); }
+
+private:
+    WeightStorage storage;
+    int K;
+    int N;
+    int Np;
+    int KP;
+    std::vector<uint16_t> w16;
+
+    void gemv_fp16(const float* x, float* acc) const {
+        for (int k = 0; k < K; ++k) {
+            const half_t* row = w16.data() + static_cast<size_t>(k) * Np;
+#if defined(DNN_WEIGHT_ONLY_AVX2) && defined(__F16C__)
+            const __m256 xk = _mm256_set1_ps(x[k]);
+            for (int j = 0; j < Np; j += 8) {
+                __m256 w = _mm256_cvtph_ps(_mm_loadu_si128(reinterpret_cast<const __m128i*>(row + j)));
+                _mm256_storeu_ps(acc + j, _mm256_fmadd_ps(xk, w, _mm256_loadu_ps(acc + j)));
+            }
+#else
+            const float xk = x[k];
+            for (int j = 0; j < Np; ++j) acc[j] += xk * half_to_float(row[j]);
+#endif
+        }
+    }
+
+    // xb: bf16 activations, KP * 2 entries (odd K zero-padded)
+    void gemv_bf16(const bf16_t* xb, float* acc) const {
+        for (int kp = 0; kp < KP; ++kp) {
+            const bf16_t* pairs = w16.data() + static_cast<size_t>(kp) * Np * 2;
+#if defined(DNN_BF16_DOT)
+            uint32_t x2;
+            std::memcpy(&x2, xb + 2 * kp, sizeof(x2));
+            const __m256bh xv = (__m256bh)_mm256_set1_epi32(static_cast<int>(x2));
+            for (int j = 0; j < Np; j += 8) {
+                __m256bh w = (__m256bh)_mm256_loadu_si256(reinterpret_cast<const __m256i*>(pairs + 2 * j));
+                _mm256_storeu_ps(acc + j, _mm256_dpbf16_ps(_mm256_loadu_ps(acc + j), xv, w));
+            }
+#elif defined(DNN_WEIGHT_ONLY_AVX2)
+            const __m256 x0 = _mm256_set1_ps(bf16_to_float(xb[2 * kp]));
+            const __m256 x1 = _mm256_set1_ps(bf16_to_float(xb[2 * kp + 1]));
+            const __m256i high = _mm256_set1_epi32(static_cast<int>(0xFFFF0000u));
+            for (int j = 0; j < Np; j += 8) {
+                __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(pairs + 2 * j));
+                __m256 w0 = _mm256_castsi256_ps(_mm256_slli_epi32(v, 16));
+                __m256 w1 = _mm256_castsi256_ps(_mm256_and_si256(v, high));
+                __m256 a = _mm256_fmadd_ps(x0, w0, _mm256_loadu_ps(acc + j));
+                _mm256_storeu_ps(acc + j, _mm256_fmadd_ps(x1, w1, a));
+            }
+#else
+            const float x0 = bf16_to_float(xb[2 * kp]);
+            const float x1 = bf16_to_float(xb[2 * kp + 1]);
+            for (int j = 0; j < Np; ++j)
+                acc[j] += x0 * bf16_to_float(pairs[2 * j]) + x1 * bf16_to_float(pairs[2 * j + 1]);
+#endif
+        }
+    }
+};
+
+/*
+ * Store every layer's W in `storage` for inference (FP32 = unpacked)
+ */
+inline void set_weight_storage(Model& model, WeightStorage storage) {
+    for (int l = 0; l < model.num_layers(); ++l) {
+        DenseLayer& layer = model.layer(l);
+        assert(layer.has_fp32_weights() && "W was freed by release_for_inference");
+        if (storage == WeightStorage::FP32)
+            layer.packed.reset();
+        else if (storage == WeightStorage::FP16 || storage == WeightStorage::BF16)
+            layer.packed.reset(new HalfWeights(layer.W, storage));
+        else
+            layer.packed.reset(new WeightOnlyWeights(layer.W, storage));
+    }
+}
@@ -10,28 +10,7 @@
 #include "core/model.h"
 #include "core/loss_functions.h"
 #include "core/optimizers.h"
-
-/* -------------------------------------------------
-   Binary weight loader
-------------------------------------------------- */
-void load_bin(const std::string& path, std::vector<float>& buffer) {
-    std::ifstream fin(path, std::ios::binary);
-    if (!fin) {
-        std::cerr << "ERROR: Cannot open " << path << std::endl;
-        std::exit(1);
-    }
-    fin.read(reinterpret_cast<char*>(buffer.data()),
-             buffer.size() * sizeof(float));
-}
-
-/* -------------------------------------------------
-   Binary weight saver
-------------------------------------------------- */
-void save_bin(const std::string& path, const std::vector<float>& buffer) {
-    std::ofstream fout(path, std::ios::binary);
-    fout.write(reinterpret_cast<const char*>(buffer.data()),
-               buffer.size() * sizeof(float));
-}
+#include "core/model_io.h"
 
 /* -------------------------------------------------
    Load single test input
@@ -54,7 +33,18 @@ int load_label(const std::string& path) {
     return y;
 }
 
-int main() {
+int main(int argc, char** argv) {
+
+    // Optional inference weight storage and export format:
+    //   dnn [fp32|fp16|bf16|int8|int4] [fp32|fp16|bf16]
+    WeightStorage storage = WeightStorage::FP32;
+    BinFormat export_format = BinFormat::FP32;
+    if ((argc > 1 && !parse_weight_storage(argv[1], storage)) ||
+        (argc > 2 && !parse_bin_format(argv[2], export_format))) {
+        std::cerr << "Usage: " << argv[0]
+                  << " [fp32|fp16|bf16|int8|int4] [fp32|fp16|bf16]\n";
+        return 1;
+    }
 
     std::cout << "\n===== DNN Forward + Backward (C++) =====\n";
 
@@ -100,6 +90,8 @@ int main() {
     d3.W_param.data = d3.W.data;  d3.b_param.data = d3.b;
     d4.W_param.data = d4.W.data;  d4.b_param.data = d4.b;
 
+    set_weight_storage(model, storage);
+
     /* -------------------------------------------------
        4. Forward warm-up
     ------------------------------------------------- */
@@ -135,6 +127,12 @@ int main() {
     /* -------------------------------------------------
        7. BACKWARD PASS (ONE STEP – correctness)
     ------------------------------------------------- */
+    // Training always runs on the fp32 weights
+    if (storage != WeightStorage::FP32) {
+        set_weight_storage(model, WeightStorage::FP32);
+        output = model.predict(x);
+    }
+
     Loss loss_fn(LossType::SPARSE_CATEGORICAL_CROSS_ENTROPY, 10);
     SGDOptimizer opt(0.01f, 0.9f);
 
@@ -157,17 +155,19 @@ int main() {
     /* -------------------------------------------------
        8. Save UPDATED weights (TF comparison)
     ------------------------------------------------- */
-    save_bin("updated_weights/dense1_W_updated.bin", d1.W.data);
-    save_bin("updated_weights/dense1_b_updated.bin", d1.b);
+    const std::string ext = bin_extension(export_format);
+
+    save_bin("updated_weights/dense1_W_updated" + ext, d1.W.data, export_format);
+    save_bin("updated_weights/dense1_b_updated" + ext, d1.b, export_format);
 
-    save_bin("updated_weights/dense2_W_updated.bin", d2.W.data);
-    save_bin("updated_weights/dense2_b_updated.bin", d2.b);
+    save_bin("updated_weights/dense2_W_updated" + ext, d2.W.data, export_format);
+    save_bin("updated_weights/dense2_b_updated" + ext, d2.b, export_format);
 
-    save_bin("updated_weights/dense3_W_updated.bin", d3.W.data);
-    save_bin("updated_weights/dense3_b_updated.bin", d3.b);
+    save_bin("updated_weights/dense3_W_updated" + ext, d3.W.data, export_format);
+    save_bin("updated_weights/dense3_b_updated" + ext, d3.b, export_format);
 
-    save_bin("updated_weights/dense4_W_updated.bin", d4.W.data);
-    save_bin("updated_weights/dense4_b_updated.bin", d4.b);
+    save_bin("updated_weights/dense4_W_updated" + ext, d4.W.data, export_format);
+    save_bin("updated_weights/dense4_b_updated" + ext, d4.b, export_format);
 
     std::cout << "\nUpdated C++ weights saved (correctness)\n";
 
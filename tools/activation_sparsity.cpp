@@ -0,0 +1,88 @@
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <string>
+#include <cmath>
+#include <cstdlib>
+
+#include "tools/common.h"
+
+/* -------------------------------------------------
+   Activation sparsity after RELU
+
+   Usage:
+     activation_sparsity <eval.rec> [weights_dir=weights]
+
+   Reports the share of non-zero RELU outputs feeding each layer over
+   the eval set, then model latency with the zero-skipping (masked)
+   path disabled vs at the default density threshold, for batch 1
+   and 64, and checks both give the same outputs.
+------------------------------------------------- */
+
+// Mean predict() time for `rows` samples, in microseconds
+static double predict_us(Model& model, const BatchView& batch) {
+    const int N = batch.rows == 1 ? 5000 : 200;
+    return time_us([&] { model.predict(batch); }, N);
+}
+
+static void set_threshold(Model& model, float threshold) {
+    for (int l = 0; l < model.num_layers(); ++l)
+        model.layer(l).sparse_input_threshold = threshold;
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        std::cerr << "Usage: " << argv[0] << " <eval.rec> [weights_dir]\n";
+        return 1;
+    }
+    const std::string eval_path = argv[1];
+    const std::string weights_dir = argc > 2 ? argv[2] : "weights";
+
+    ReferenceNet net(weights_dir);
+    Model& model = net.model;
+
+    Dataset eval;
+    if (!eval.open(eval_path)) return 1;
+
+    // Input density of layers 2..4 over the eval set
+    std::vector<double> nonzero(model.num_layers(), 0.0);
+    double total = 0.0;
+    DatasetBatches batches(eval, 256);
+    BatchView batch;
+    batches.start_epoch(0);
+    while (batches.next(batch)) {
+        model.predict(batch);
+        for (int l = 1; l < model.num_layers(); ++l)
+            nonzero[l] += model.layer(l - 1).activation.mask.nnz();
+        total += batch.rows;
+    }
+
+    std::cout << std::fixed << std::setprecision(3) << "Layer   input density\n";
+    for (int l = 1; l < model.num_layers(); ++l)
+        std::cout << "dense" << l + 1 << "  "
+                  << nonzero[l] / (total * model.layer(l).W.rows) << "\n";
+
+    const float threshold = model.layer(1).sparse_input_threshold;
+    std::cout << "\nrows   dense-only us   threshold " << threshold << " us   speedup   max |diff|\n";
+    for (int rows : { 1, 64 }) {
+        BatchView x = eval.batch(0, rows);
+
+        set_threshold(model, 0.0f);
+        Tensor dense_out = model.predict(x);
+        double dense_us = predict_us(model, x);
+
+        set_threshold(model, threshold);
+        Tensor indexed_out = model.predict(x);
+        double indexed_us = predict_us(model, x);
+
+        float max_diff = 0.0f;
+        for (size_t j = 0; j < dense_out.data.size(); ++j)
+            max_diff = std::max(max_diff, std::fabs(dense_out.data[j] - indexed_out.data[j]));
+
+        std::cout << std::setw(4) << rows << "   " << std::setw(13) << dense_us << "   "
+                  << std::setw(16) << indexed_us << "   " << std::setw(6) << dense_us / indexed_us << "x   "
+                  << std::scientific << std::setprecision(1) << max_diff
+                  << std::fixed << std::setprecision(3) << "\n";
+    }
+    return 0;
+}
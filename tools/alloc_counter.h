@@ -0,0 +1,76 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+
+/* -------------------------------------------------
+   Heap allocation counter for the allocation reports
+
+   Replaces the whole global operator new / delete set (plain, array,
+   nothrow, aligned and sized forms) with malloc / aligned_alloc /
+   free and counts every allocation in `allocations`. All forms are
+   replaced together so each delete matches its new (ASan otherwise
+   reports alloc-dealloc-mismatch). Replacement functions are program
+   wide: include from the tool's single source file only.
+------------------------------------------------- */
+
+static std::atomic<long> allocations{0};
+
+// Kept out of line so GCC does not match inlined malloc() / free()
+// against new / delete
+[[gnu::noinline]] static void* counted_alloc(std::size_t n) {
+    allocations++;
+    return std::malloc(n ? n : 1);
+}
+
+[[gnu::noinline]] static void* counted_alloc(std::size_t n, std::align_val_t align) {
+    allocations++;
+    const std::size_t a = static_cast<std::size_t>(align);
+    return std::aligned_alloc(a, (n + a - 1) / a * a);
+}
+
+void* operator new(std::size_t n) {
+    if (void* p = counted_alloc(n)) return p;
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t n) {
+    if (void* p = counted_alloc(n)) return p;
+    throw std::bad_alloc();
+}
+
+void* operator new(std::size_t n, std::align_val_t align) {
+    if (void* p = counted_alloc(n, align)) return p;
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t n, std::align_val_t align) {
+    if (void* p = counted_alloc(n, align)) return p;
+    throw std::bad_alloc();
+}
+
+void* operator new(std::size_t n, const std::nothrow_t&) noexcept { return counted_alloc(n); }
+void* operator new[](std::size_t n, const std::nothrow_t&) noexcept { return counted_alloc(n); }
+
+void* operator new(std::size_t n, std::align_val_t align, const std::nothrow_t&) noexcept {
+    return counted_alloc(n, align);
+}
+
+void* operator new[](std::size_t n, std::align_val_t align, const std::nothrow_t&) noexcept {
+    return counted_alloc(n, align);
+}
+
+[[gnu::noinline]] void operator delete(void* p) noexcept { std::free(p); }
+[[gnu::noinline]] void operator delete[](void* p) noexcept { std::free(p); }
+[[gnu::noinline]] void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+[[gnu::noinline]] void operator delete[](void* p, std::size_t) noexcept { std::free(p); }
+[[gnu::noinline]] void operator delete(void* p, const std::nothrow_t&) noexcept { std::free(p); }
+[[gnu::noinline]] void operator delete[](void* p, const std::nothrow_t&) noexcept { std::free(p); }
+[[gnu::noinline]] void operator delete(void* p, std::align_val_t) noexcept { std::free(p); }
+[[gnu::noinline]] void operator delete[](void* p, std::align_val_t) noexcept { std::free(p); }
+[[gnu::noinline]] void operator delete(void* p, std::size_t, std::align_val_t) noexcept { std::free(p); }
+[[gnu::noinline]] void operator delete[](void* p, std::size_t, std::align_val_t) noexcept { std::free(p); }
+[[gnu::noinline]] void operator delete(void* p, std::align_val_t, const std::nothrow_t&) noexcept { std::free(p); }
+[[gnu::noinline]] void operator delete[](void* p, std::align_val_t, const std::nothrow_t&) noexcept { std::free(p); }
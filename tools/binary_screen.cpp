@@ -0,0 +1,132 @@
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <string>
+#include <cstdlib>
+
+#include "core/loss_functions.h"
+#include "core/optimizers.h"
+#include "core/binary_layer.h"
+#include "tools/common.h"
+
+/* -------------------------------------------------
+   Binary / ternary screening model
+
+   Usage:
+     binary_screen <eval.rec> [binary|ternary] [weights_dir=weights]
+                   [train.rec] [epochs=1] [lr=0.0005]
+
+   1. builds the reference network with the hidden layers dense2 and
+      dense3 as BinaryDenseLayers (dense1 / dense4 stay fp32, as in
+      XNOR-Net), initialised from the fp32 weights
+   2. with train.rec, trains it with Model::fit (straight-through
+      estimator)
+   3. reports accuracy and batch-1 latency, and per-layer weight bytes
+------------------------------------------------- */
+
+// Mean batch-1 forward time of layers [first, last], in microseconds
+static double layers_us(Model& model, int first, int last, const Dataset& data) {
+    const int N = 2000;
+    BatchView sample = data.batch(0, 1);
+    model.predict(sample);
+    std::vector<Tensor> inputs;
+    for (int l = first; l <= last; ++l) {
+        const DenseLayer& layer = model.layer(l);
+        Tensor x(1, layer.W.rows);
+        std::copy(layer.input_ptr, layer.input_ptr + layer.W.rows, x.data.begin());
+        inputs.push_back(x);
+    }
+    return time_us([&] {
+        for (int l = first; l <= last; ++l)
+            model.layer(l).forward(inputs[l - first]);
+    }, N);
+}
+
+static void copy_weights(const DenseLayer& src, DenseLayer& dst) {
+    dst.W.data = src.W.data;
+    dst.b = src.b;
+    dst.W_param.data = dst.W.data;
+    dst.b_param.data = dst.b;
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        std::cerr << "Usage: " << argv[0]
+                  << " <eval.rec> [binary|ternary] [weights_dir] [train.rec] [epochs] [lr]\n";
+        return 1;
+    }
+    const std::string eval_path = argv[1];
+    const std::string mode_name = argc > 2 ? argv[2] : "binary";
+    const std::string weights_dir = argc > 3 ? argv[3] : "weights";
+    const std::string train_path = argc > 4 ? argv[4] : "";
+    const int epochs = argc > 5 ? std::atoi(argv[5]) : 1;
+    const float lr = argc > 6 ? static_cast<float>(std::atof(argv[6])) : 0.0005f;
+
+    WeightBinarization mode;
+    if (mode_name == "binary") {
+        mode = WeightBinarization::BINARY;
+    } else if (mode_name == "ternary") {
+        mode = WeightBinarization::TERNARY;
+    } else {
+        std::cerr << "ERROR: unknown mode '" << mode_name << "' (binary|ternary)" << std::endl;
+        return 1;
+    }
+
+    ReferenceNet net(weights_dir);
+    Model& reference = net.model;
+
+    DenseLayer s1(80, 256, ActivationType::RELU);
+    // Inputs are ReLU outputs: {0, 1} binarization (AND + popcount)
+    BinaryDenseLayer s2(256, 128, ActivationType::RELU, mode, InputBinarization::POSITIVE);
+    BinaryDenseLayer s3(128, 64,  ActivationType::RELU, mode, InputBinarization::POSITIVE);
+    DenseLayer s4(64,  10,  ActivationType::SOFTMAX);
+    copy_weights(net.d1, s1);
+    copy_weights(net.d2, s2);
+    copy_weights(net.d3, s3);
+    copy_weights(net.d4, s4);
+    s2.pack();
+    s3.pack();
+
+    Model screen;
+    screen.add(s1);
+    screen.add(s2);
+    screen.add(s3);
+    screen.add(s4);
+
+    Dataset eval;
+    if (!eval.open(eval_path)) return 1;
+
+    std::cout << std::fixed << std::setprecision(4)
+              << "Accuracy fp32              : " << accuracy(reference, eval) << "\n"
+              << "Accuracy " << std::setw(7) << std::left << mode_name << std::right
+              << " one-shot   : " << accuracy(screen, eval) << "\n";
+
+    if (!train_path.empty()) {
+        Dataset train;
+        if (!train.open(train_path)) return 1;
+
+        Loss loss(LossType::SPARSE_CATEGORICAL_CROSS_ENTROPY, 10);
+        SGDOptimizer opt(lr, 0.9f);
+        screen.compile(loss, opt);
+        screen.fit(train, epochs, 64);
+        std::cout << "Accuracy " << std::setw(7) << std::left << mode_name << std::right
+                  << " trained    : " << accuracy(screen, eval) << "\n";
+    }
+
+    std::cout << "\nLayer   shape      bytes fp32 -> packed\n";
+    const BinaryDenseLayer* binary[2] = { &s2, &s3 };
+    for (int l = 0; l < 2; ++l) {
+        const BinaryDenseLayer& layer = *binary[l];
+        std::cout << "dense" << l + 2 << "  " << std::setw(3) << layer.W.rows << "x"
+                  << std::setw(3) << layer.W.cols << "   "
+                  << std::setw(6) << layer.W.data.size() * sizeof(float) << " -> "
+                  << std::setw(6) << layer.packed_bytes() << "\n";
+    }
+
+    std::cout << std::setprecision(3)
+              << "\nBatch-1 latency dense2+dense3 : " << layers_us(reference, 1, 2, eval)
+              << " us fp32 -> " << layers_us(screen, 1, 2, eval) << " us " << mode_name << "\n"
+              << "Batch-1 latency full model    : " << layers_us(reference, 0, 3, eval)
+              << " us fp32 -> " << layers_us(screen, 0, 3, eval) << " us " << mode_name << "\n";
+    return 0;
+}
@@ -0,0 +1,102 @@
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <random>
+#include <cmath>
+#include <string>
+#include <cstdlib>
+#include <algorithm>
+
+#include "core/tensor.h"
+#include "core/dense_layer.h"
+#include "core/model.h"
+#include "core/dataset.h"
+#include "core/loss_functions.h"
+#include "core/optimizers.h"
+
+/* -------------------------------------------------
+   Gradient checkpointing report
+
+   Usage:
+     checkpointing <train.rec> [depth=16] [width=256] [batch_size=256]
+                   [epochs=1]
+
+   Builds a deep RELU MLP (input -> depth x width -> 10, He init,
+   fixed seed) twice and trains one copy normally and one with
+   checkpointing (segments of ceil(sqrt(depth)) layers). Reports the
+   peak bytes cached for backward, training time, and the largest
+   weight or bias difference between the two copies (expected 0).
+------------------------------------------------- */
+
+static void build(Model& model, int input_dim, int depth, int width) {
+    std::mt19937 rng(42);
+    int in = input_dim;
+    for (int l = 0; l <= depth; ++l) {
+        const bool last = l == depth;
+        DenseLayer& layer = model.add(in, last ? 10 : width,
+                                      last ? ActivationType::SOFTMAX : ActivationType::RELU);
+        std::normal_distribution<float> init(0.0f, std::sqrt(2.0f / in));
+        for (auto& w : layer.W_param.data) w = init(rng);
+        layer.sync_weights();
+        in = width;
+    }
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        std::cerr << "Usage: " << argv[0]
+                  << " <train.rec> [depth] [width] [batch_size] [epochs]\n";
+        return 1;
+    }
+    const std::string train_path = argv[1];
+    const int depth = argc > 2 ? std::atoi(argv[2]) : 16;
+    const int width = argc > 3 ? std::atoi(argv[3]) : 256;
+    const int batch_size = argc > 4 ? std::atoi(argv[4]) : 256;
+    const int epochs = argc > 5 ? std::atoi(argv[5]) : 1;
+
+    Dataset train;
+    if (!train.open(train_path)) return 1;
+
+    Loss loss(LossType::SPARSE_CATEGORICAL_CROSS_ENTROPY, 10);
+    SGDOptimizer opt_plain(0.01f, 0.9f), opt_ckpt(0.01f, 0.9f);
+
+    Model plain, ckpt;
+    build(plain, train.num_features(), depth, width);
+    build(ckpt, train.num_features(), depth, width);
+    plain.compile(loss, opt_plain);
+    ckpt.compile(loss, opt_ckpt);
+    plain.set_checkpointing(false);
+    ckpt.set_checkpointing(true);
+
+    std::cout << "== no checkpointing ==\n";
+    auto t0 = std::chrono::high_resolution_clock::now();
+    plain.fit(train, epochs, batch_size);
+    auto t1 = std::chrono::high_resolution_clock::now();
+
+    std::cout << "== checkpointing ==\n";
+    auto t2 = std::chrono::high_resolution_clock::now();
+    ckpt.fit(train, epochs, batch_size);
+    auto t3 = std::chrono::high_resolution_clock::now();
+
+    float max_diff = 0.0f;
+    auto compare = [&](const std::vector<float>& a, const std::vector<float>& b) {
+        for (size_t i = 0; i < a.size(); ++i)
+            max_diff = std::max(max_diff, std::fabs(a[i] - b[i]));
+    };
+    for (int l = 0; l < plain.num_layers(); ++l) {
+        compare(plain.layer(l).W_param.data, ckpt.layer(l).W_param.data);
+        compare(plain.layer(l).b_param.data, ckpt.layer(l).b_param.data);
+    }
+
+    const double plain_s = std::chrono::duration<double>(t1 - t0).count();
+    const double ckpt_s = std::chrono::duration<double>(t3 - t2).count();
+    std::cout << std::fixed << std::setprecision(3)
+              << "Peak cached activations: " << plain.peak_cache_bytes() / 1048576.0 << " MiB vs "
+              << ckpt.peak_cache_bytes() / 1048576.0 << " MiB ("
+              << static_cast<double>(plain.peak_cache_bytes()) / ckpt.peak_cache_bytes() << "x less)\n"
+              << "Training time: " << plain_s << " s vs " << ckpt_s << " s ("
+              << ckpt_s / plain_s << "x)\n"
+              << std::scientific << std::setprecision(1)
+              << "Max |weight/bias diff|: " << max_diff << "\n";
+    return 0;
+}
@@ -0,0 +1,89 @@
+#include <iostream>
+#include <fstream>
+#include <iomanip>
+#include <vector>
+#include <string>
+#include <cstdlib>
+#include <filesystem>
+
+#include "core/weight_clustering.h"
+#include "tools/common.h"
+
+/* -------------------------------------------------
+   Weight clustering (k-means codebook + LUT GEMV)
+
+   Usage:
+     cluster_weights <eval.rec> [centroids=16] [weights_dir=weights]
+                     [out_dir=clustered]
+
+   1. reports bytes / accuracy / top-1 agreement / batch-1 latency
+      for fp32, 256 centroids (8-bit) and 16 centroids (4-bit)
+   2. writes, for `centroids`, dense{i}_codebook.bin (fp32) and
+      dense{i}_W_idx.bin (one uint8 index per weight, row-major)
+------------------------------------------------- */
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        std::cerr << "Usage: " << argv[0] << " <eval.rec> [centroids] [weights_dir] [out_dir]\n";
+        return 1;
+    }
+    const std::string eval_path = argv[1];
+    const int centroids = argc > 2 ? std::atoi(argv[2]) : 16;
+    const std::string weights_dir = argc > 3 ? argv[3] : "weights";
+    const std::string out_dir = argc > 4 ? argv[4] : "clustered";
+
+    if (centroids != 16 && centroids != 256) {
+        std::cerr << "ERROR: centroids must be 16 or 256" << std::endl;
+        return 1;
+    }
+
+    ReferenceNet net(weights_dir);
+    Model& model = net.model;
+
+    Dataset eval;
+    if (!eval.open(eval_path)) return 1;
+
+    EvalRun fp32 = run_eval(model, eval);
+    size_t fp32_bytes = 0;
+    for (int l = 0; l < model.num_layers(); ++l)
+        fp32_bytes += model.layer(l).W.data.size() * sizeof(float);
+
+    std::cout << std::fixed << std::setprecision(4)
+              << "mode            bytes   accuracy  agreement  latency_ms\n"
+              << "fp32         " << std::setw(8) << fp32_bytes << "   " << fp32.accuracy()
+              << "    1.0000     " << latency_ms(model, eval) << "\n";
+
+    for (int c : { 256, 16 }) {
+        set_codebook_weights(model, c);
+        EvalRun res = run_eval(model, eval);
+        size_t bytes = 0;
+        for (int l = 0; l < model.num_layers(); ++l) bytes += model.layer(l).packed->bytes();
+
+        std::cout << std::setw(3) << c << " centroids" << std::setw(8) << bytes << "   "
+                  << res.accuracy() << "    " << res.agreement(fp32) << "     "
+                  << latency_ms(model, eval) << "\n";
+    }
+
+    /* -------------------------------------------------
+       Write codebooks + indices
+    ------------------------------------------------- */
+    set_codebook_weights(model, centroids);
+    std::filesystem::create_directories(out_dir);
+    for (int l = 0; l < model.num_layers(); ++l) {
+        const DenseLayer& layer = model.layer(l);
+        const CodebookWeights& cb = static_cast<const CodebookWeights&>(*layer.packed);
+        std::string prefix = out_dir + "/dense" + std::to_string(l + 1);
+
+        std::vector<uint8_t> idx(layer.W.data.size());
+        for (int k = 0; k < layer.W.rows; ++k)
+            for (int j = 0; j < layer.W.cols; ++j)
+                idx[static_cast<size_t>(k) * layer.W.cols + j] = static_cast<uint8_t>(cb.index(k, j));
+
+        std::ofstream fi(prefix + "_W_idx.bin", std::ios::binary);
+        fi.write(reinterpret_cast<const char*>(idx.data()), idx.size());
+        save_bin(prefix + "_codebook.bin", cb.centroids());
+        save_bin(prefix + "_b.bin", layer.b);
+    }
+    std::cout << centroids << "-centroid codebooks written to " << out_dir << "/\n";
+    return 0;
+}
@@ -0,0 +1,117 @@
+#pragma once
+
+#include <chrono>
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <cstdint>
+#include <random>
+
+#include "core/tensor.h"
+#include "core/dense_layer.h"
+#include "core/model.h"
+#include "core/dataset.h"
+#include "core/model_io.h"
+
+/* -------------------------------------------------
+   Shared by the tools: the reference network, eval-set accuracy
+   and timing helpers
+------------------------------------------------- */
+
+// The 80-256-128-64-10 network of main.cpp, loaded as by
+// load_model_weights(storage, inference_only); the layers live here,
+// so a ReferenceNet is neither copied nor moved
+struct ReferenceNet {
+    DenseLayer d1{80, 256, ActivationType::RELU};
+    DenseLayer d2{256, 128, ActivationType::RELU};
+    DenseLayer d3{128, 64,  ActivationType::RELU};
+    DenseLayer d4{64,  10,  ActivationType::SOFTMAX};
+    Model model;
+
+    explicit ReferenceNet(const std::string& weights_dir,
+                          WeightStorage storage = WeightStorage::FP32,
+                          bool inference_only = false) {
+        model.add(d1);
+        model.add(d2);
+        model.add(d3);
+        model.add(d4);
+        load_model_weights(model, weights_dir, storage, inference_only);
+    }
+
+    ReferenceNet(const ReferenceNet&) = delete;
+    ReferenceNet& operator=(const ReferenceNet&) = delete;
+};
+
+// Synthetic set labelled by `model` itself: `samples` rows of
+// N(0, 1.5^2) features (mt19937 from `seed`), label = argmax of the
+// model's output
+inline bool write_teacher_set(Model& model, const std::string& path, int samples, unsigned seed) {
+    const int K = model.layer(0).W.rows;
+    std::mt19937 rng(seed);
+    std::normal_distribution<float> dist(0.0f, 1.0f);
+    DatasetWriter writer;
+    if (!writer.open(path, K)) return false;
+    Tensor x(1, K);
+    for (int i = 0; i < samples; ++i) {
+        for (float& v : x.data) v = dist(rng) * 1.5f;
+        writer.append(x.data.data(), argmax(model.predict(x)));
+    }
+    return writer.close();
+}
+
+// Predictions of `model` over a dataset, in record order
+struct EvalRun {
+    std::vector<int> predictions;
+    std::vector<float> outputs;   // rows x classes
+    int64_t correct = 0;
+
+    double accuracy() const {
+        return predictions.empty() ? 0.0 : static_cast<double>(correct) / predictions.size();
+    }
+
+    // Share of predictions equal to other's (same dataset)
+    double agreement(const EvalRun& other) const {
+        int64_t agree = 0;
+        for (size_t i = 0; i < predictions.size(); ++i)
+            if (predictions[i] == other.predictions[i]) agree++;
+        return predictions.empty() ? 0.0 : static_cast<double>(agree) / predictions.size();
+    }
+};
+
+inline EvalRun run_eval(Model& model, const Dataset& data) {
+    EvalRun res;
+    DatasetBatches batches(data, 256);
+    BatchView batch;
+    batches.start_epoch(0);
+    while (batches.next(batch)) {
+        Tensor out = model.predict(batch);
+        for (int r = 0; r < batch.rows; ++r) {
+            int p = argmax_row(out, r);
+            res.predictions.push_back(p);
+            if (p == batch.label(r)) res.correct++;
+        }
+        res.outputs.insert(res.outputs.end(), out.data.begin(), out.data.end());
+    }
+    return res;
+}
+
+inline double accuracy(Model& model, const Dataset& data) {
+    return run_eval(model, data).accuracy();
+}
+
+// Mean time of fn() in microseconds
+template <typename Fn>
+double time_us(Fn fn, int iterations) {
+    fn();   // warm-up
+    auto start = std::chrono::high_resolution_clock::now();
+    for (int i = 0; i < iterations; ++i) fn();
+    auto end = std::chrono::high_resolution_clock::now();
+    return std::chrono::duration<double, std::micro>(end - start).count() / iterations;
+}
+
+// Mean batch-1 predict() latency over the first `samples` records, in ms
+inline double latency_ms(Model& model, const Dataset& data, int samples = 500) {
+    const int N = static_cast<int>(std::min<int64_t>(samples, data.size()));
+    int i = 0;
+    return time_us([&] { model.predict(data.batch(i++ % N, 1)); }, N) / 1000.0;
+}
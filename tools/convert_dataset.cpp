@@ -0,0 +1,255 @@
+#include <iostream>
+#include <fstream>
+#include <vector>
+#include <string>
+#include <thread>
+#include <chrono>
+#include <charconv>
+#include <cstring>
+#include <cmath>
+
+#include "core/dataset.h"
+
+/* -------------------------------------------------
+   Text -> binary record dataset converter
+
+   Usage:
+     convert_dataset <features.txt> <labels.txt> <out.rec>
+                     [num_features=80] [threads=all cores]
+
+   features.txt: whitespace-separated floats, num_features per
+                 sample (same format as data/test_input.txt)
+   labels.txt  : one integer per sample (float text such as 3.0 is
+                 accepted; non-integer values are an error)
+
+   Input is read in large blocks; each block is cut at whitespace
+   into one chunk per thread and parsed with std::from_chars.
+------------------------------------------------- */
+
+static const size_t CHUNK_BYTES = 16u << 20;   // per thread, per block
+
+static bool is_space(char c) {
+    return c == ' ' || c == '\n' || c == '\r' || c == '\t' || c == '\f' || c == '\v';
+}
+
+/*
+ * Parse every float in [begin, end); begin/end sit on token boundaries
+ */
+static bool parse_floats(const char* begin, const char* end, std::vector<float>& out) {
+    out.clear();
+    out.reserve(static_cast<size_t>(end - begin) / 8);
+
+    const char* p = begin;
+    while (true) {
+        while (p < end && is_space(*p)) ++p;
+        if (p == end) return true;
+        if (*p == '+') ++p;
+
+        float v;
+        auto res = std::from_chars(p, end, v);
+        if (res.ec != std::errc()) {
+            const char* tok_end = p;
+            while (tok_end < end && !is_space(*tok_end)) ++tok_end;
+            std::cerr << "ERROR: Cannot parse '" << std::string(p, tok_end)
+                      << "' as a float" << std::endl;
+            return false;
+        }
+        out.push_back(v);
+        p = res.ptr;
+    }
+}
+
+/*
+ * Streams a text file block by block and parses each block on all threads
+ */
+class ParallelFloatReader {
+public:
+    ParallelFloatReader(const std::string& path, int threads)
+        : fin(path, std::ios::binary), num_threads(threads), parsed(threads) {}
+
+    bool ok() const { return static_cast<bool>(fin); }
+
+    /*
+     * Parse the next block; values are appended to `out` in file order.
+     * Returns false at end of file or on a parse error (see `failed`).
+     */
+    bool next(std::vector<float>& out) {
+        if (eof && carry.empty()) return false;
+
+        buf.assign(carry.begin(), carry.end());
+        carry.clear();
+
+        size_t want = CHUNK_BYTES * num_threads;
+        size_t old = buf.size();
+        buf.resize(old + want);
+        fin.read(buf.data() + old, static_cast<std::streamsize>(want));
+        buf.resize(old + static_cast<size_t>(fin.gcount()));
+        if (!fin) eof = true;
+
+        // Keep a token split by the block boundary for the next block
+        size_t cut = buf.size();
+        if (!eof) {
+            while (cut > 0 && !is_space(buf[cut - 1])) --cut;
+            carry.assign(buf.begin() + cut, buf.end());
+        }
+        if (cut == 0) {
+            if (eof) return false;
+            return next(out);   // a single token longer than a block
+        }
+
+        // One whitespace-aligned chunk per thread
+        std::vector<const char*> bounds(num_threads + 1);
+        const char* base = buf.data();
+        bounds[0] = base;
+        for (int t = 1; t < num_threads; ++t) {
+            const char* p = std::max(bounds[t - 1], base + cut * t / num_threads);
+            while (p < base + cut && !is_space(*p)) ++p;
+            bounds[t] = p;
+        }
+        bounds[num_threads] = base + cut;
+
+        std::vector<char> ok_flags(num_threads, 1);
+        std::vector<std::thread> workers;
+        for (int t = 0; t < num_threads; ++t) {
+            workers.emplace_back([&, t] {
+                ok_flags[t] = parse_floats(bounds[t], bounds[t + 1], parsed[t]);
+            });
+        }
+        for (auto& w : workers) w.join();
+
+        for (int t = 0; t < num_threads; ++t) {
+            if (!ok_flags[t]) {
+                failed = true;
+                return false;
+            }
+            out.insert(out.end(), parsed[t].begin(), parsed[t].end());
+        }
+        return true;
+    }
+
+    bool failed = false;
+
+private:
+    std::ifstream fin;
+    int num_threads;
+    bool eof = false;
+    std::vector<char> buf;
+    std::vector<char> carry;
+    std::vector<std::vector<float>> parsed;
+};
+
+int main(int argc, char** argv) {
+    if (argc < 4) {
+        std::cerr << "Usage: " << argv[0]
+                  << " <features.txt> <labels.txt> <out.rec> [num_features=80] [threads]\n";
+        return 1;
+    }
+
+    const std::string features_path = argv[1];
+    const std::string labels_path = argv[2];
+    const std::string out_path = argv[3];
+    const int num_features = argc > 4 ? std::atoi(argv[4]) : 80;
+    int threads = argc > 5 ? std::atoi(argv[5])
+                           : static_cast<int>(std::thread::hardware_concurrency());
+    if (threads < 1) threads = 1;
+    if (num_features < 1) {
+        std::cerr << "ERROR: num_features must be positive\n";
+        return 1;
+    }
+
+    auto t_start = std::chrono::high_resolution_clock::now();
+
+    /* -------------------------------------------------
+       1. Labels (small: parse fully up front)
+    ------------------------------------------------- */
+    std::vector<float> label_values;
+    {
+        ParallelFloatReader reader(labels_path, threads);
+        if (!reader.ok()) {
+            std::cerr << "ERROR: Cannot open " << labels_path << std::endl;
+            return 1;
+        }
+        while (reader.next(label_values)) {}
+        if (reader.failed) return 1;
+    }
+    for (size_t i = 0; i < label_values.size(); ++i) {
+        const float v = label_values[i];
+        if (v != std::trunc(v) || v < -2147483648.0f || v >= 2147483648.0f) {
+            std::cerr << "ERROR: Label " << i << " in " << labels_path
+                      << " is not an integer (" << v << ")" << std::endl;
+            return 1;
+        }
+    }
+
+    /* -------------------------------------------------
+       2. Features, streamed block by block
+    ------------------------------------------------- */
+    ParallelFloatReader reader(features_path, threads);
+    if (!reader.ok()) {
+        std::cerr << "ERROR: Cannot open " << features_path << std::endl;
+        return 1;
+    }
+
+    DatasetWriter writer;
+    if (!writer.open(out_path, num_features)) return 1;
+
+    const size_t stride = writer.record_stride();
+    const size_t label_offset = writer.label_offset();
+
+    std::vector<float> pending;     // parsed floats not yet written
+    std::vector<char> records;
+    uint64_t written = 0;
+
+    while (reader.next(pending)) {
+        size_t available = pending.size() / num_features;
+        if (written + available > label_values.size()) {
+            std::cerr << "ERROR: More samples than labels in " << labels_path << std::endl;
+            writer.abort();
+            return 1;
+        }
+
+        records.assign(available * stride, 0);
+        for (size_t r = 0; r < available; ++r) {
+            char* rec = records.data() + r * stride;
+            std::memcpy(rec, pending.data() + r * num_features,
+                        num_features * sizeof(float));
+            int32_t y = static_cast<int32_t>(label_values[written + r]);
+            std::memcpy(rec + label_offset, &y, sizeof(y));
+        }
+        writer.append_raw(records.data(), available);
+
+        written += available;
+
+        // Keep the partial sample for the next block
+        pending.erase(pending.begin(), pending.begin() + available * num_features);
+    }
+    if (reader.failed) {
+        writer.abort();
+        return 1;
+    }
+
+    if (!pending.empty()) {
+        std::cerr << "ERROR: " << features_path << " ends with a partial sample ("
+                  << pending.size() << " of " << num_features << " floats)" << std::endl;
+        writer.abort();
+        return 1;
+    }
+    if (written != label_values.size()) {
+        std::cerr << "ERROR: " << written << " samples but "
+                  << label_values.size() << " labels" << std::endl;
+        writer.abort();
+        return 1;
+    }
+    if (!writer.close()) {
+        std::cerr << "ERROR: Failed writing " << out_path << std::endl;
+        return 1;
+    }
+
+    auto t_end = std::chrono::high_resolution_clock::now();
+    double seconds = std::chrono::duration<double>(t_end - t_start).count();
+
+    std::cout << "Converted " << written << " samples x " << num_features
+              << " features using "
+              << threads << " threads in " << seconds << " s\n";
+    return 0;
+}
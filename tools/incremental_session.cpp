@@ -0,0 +1,105 @@
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <random>
+#include <vector>
+#include <string>
+#include <cmath>
+#include <cstdlib>
+
+#include "core/incremental.h"
+#include "tools/common.h"
+
+/* -------------------------------------------------
+   Incremental first-layer session
+
+   Usage:
+     incremental_session <eval.rec> [requests=20000] [weights_dir=weights]
+
+   Replays request streams where each request changes `c` of the 80
+   features of the previous one (values taken from other eval
+   samples), for c = 1 .. 32, and reports per-request latency of a
+   full predict vs IncrementalSession, plus the largest output
+   difference and argmax agreement between the two.
+------------------------------------------------- */
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        std::cerr << "Usage: " << argv[0] << " <eval.rec> [requests] [weights_dir]\n";
+        return 1;
+    }
+    const std::string eval_path = argv[1];
+    const int requests = argc > 2 ? std::atoi(argv[2]) : 20000;
+    const std::string weights_dir = argc > 3 ? argv[3] : "weights";
+    if (requests < 1) {
+        std::cerr << "Usage: " << argv[0] << " <eval.rec> [requests] [weights_dir]\n"
+                  << "ERROR: requests must be positive\n";
+        return 1;
+    }
+
+    ReferenceNet net(weights_dir);
+    Model& model = net.model;
+
+    Dataset eval;
+    if (!eval.open(eval_path)) return 1;
+    if (eval.size() == 0) {
+        std::cerr << "ERROR: " << eval_path << " has no samples" << std::endl;
+        return 1;
+    }
+    const int K = eval.num_features();
+
+    std::cout << std::fixed << std::setprecision(3)
+              << "changed   full us   session us   speedup   max |diff|   agree\n";
+
+    for (int c : { 1, 2, 4, 8, 16, 32 }) {
+        // Request stream: each request edits c features of the previous one
+        std::mt19937 rng(c);
+        std::uniform_int_distribution<int> feature(0, K - 1);
+        std::uniform_int_distribution<int64_t> sample(0, eval.size() - 1);
+        std::vector<Tensor> stream;
+        Tensor x(1, K);
+        std::copy(eval.record(0), eval.record(0) + K, x.data.begin());
+        for (int r = 0; r < requests; ++r) {
+            const float* donor = eval.record(sample(rng));
+            for (int i = 0; i < c; ++i) {
+                int k = feature(rng);
+                x.data[k] = donor[k];
+            }
+            stream.push_back(x);
+        }
+
+        // Full forward pass per request
+        std::vector<Tensor> full;
+        full.reserve(requests);
+        auto start = std::chrono::high_resolution_clock::now();
+        for (const Tensor& req : stream) full.push_back(model.predict(req));
+        auto end = std::chrono::high_resolution_clock::now();
+        double full_us = std::chrono::duration<double, std::micro>(end - start).count() / requests;
+
+        // Incremental session
+        IncrementalSession session(model);
+        std::vector<Tensor> inc;
+        inc.reserve(requests);
+        start = std::chrono::high_resolution_clock::now();
+        for (const Tensor& req : stream) inc.push_back(session.predict(req));
+        end = std::chrono::high_resolution_clock::now();
+        double inc_us = std::chrono::duration<double, std::micro>(end - start).count() / requests;
+
+        float max_diff = 0.0f;
+        int agree = 0;
+        for (int r = 0; r < requests; ++r) {
+            for (size_t j = 0; j < full[r].data.size(); ++j)
+                max_diff = std::max(max_diff, std::fabs(full[r].data[j] - inc[r].data[j]));
+            if (argmax(full[r]) == argmax(inc[r])) agree++;
+        }
+
+        std::cout << std::setw(7) << c << "   "
+                  << std::setw(7) << full_us << "   "
+                  << std::setw(10) << inc_us << "   "
+                  << std::setw(6) << full_us / inc_us << "x   "
+                  << std::scientific << std::setprecision(1) << std::setw(10) << max_diff
+                  << std::fixed << std::setprecision(4) << "   "
+                  << static_cast<float>(agree) / requests << std::setprecision(3) << "\n";
+    }
+    return 0;
+}
@@ -0,0 +1,188 @@
+#include <iostream>
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+
+#include "core/dataset.h"
+#include "core/data_loader.h"
+#include "core/streaming_dataset.h"
+#include "core/sharded_dataset.h"
+
+/* -------------------------------------------------
+   Batch loader consistency check
+
+   Usage:
+     loader_check <data.rec> [batch=64]
+
+   Streams epochs of <data.rec> through each batch loader and checks
+   the samples (features + label) against the memory-mapped Dataset:
+     DataLoader   no shuffle: same samples in file order
+                  shuffle   : same samples, each exactly once, and
+                              the same order for the same seed
+     StreamingDataset  the same, with chunk shuffle; then on a copy
+                  truncated after open(): the epoch must stop early
+                  with failed() set
+     ShardedDataset    the file split into 5 shards: every sample once,
+                  the same order for the same seed; then with one
+                  shard deleted after open(): the epoch must stop
+                  with failed() set
+   Exits non-zero on any mismatch.
+------------------------------------------------- */
+
+// FNV-1a over a sample's feature bytes and label
+static uint64_t fingerprint(const float* features, int cols, int32_t label) {
+    uint64_t h = 1469598103934665603ull;
+    auto mix = [&](const void* p, size_t n) {
+        const unsigned char* b = static_cast<const unsigned char*>(p);
+        for (size_t i = 0; i < n; ++i) {
+            h ^= b[i];
+            h *= 1099511628211ull;
+        }
+    };
+    mix(features, cols * sizeof(float));
+    mix(&label, sizeof(label));
+    return h;
+}
+
+static std::vector<uint64_t> reference(const Dataset& data) {
+    std::vector<uint64_t> out;
+    for (int64_t i = 0; i < data.size(); ++i)
+        out.push_back(fingerprint(data.record(i), data.num_features(), data.label(i)));
+    return out;
+}
+
+// One epoch from src, a fingerprint per sample in stream order
+static std::vector<uint64_t> stream(BatchSource& src, int epoch) {
+    std::vector<uint64_t> out;
+    BatchView batch;
+    src.start_epoch(epoch);
+    while (src.next(batch))
+        for (int r = 0; r < batch.rows; ++r)
+            out.push_back(fingerprint(batch.features + static_cast<size_t>(r) * batch.stride,
+                                      batch.cols, batch.label(r)));
+    return out;
+}
+
+static bool same_samples(std::vector<uint64_t> a, std::vector<uint64_t> b) {
+    std::sort(a.begin(), a.end());
+    std::sort(b.begin(), b.end());
+    return a == b;
+}
+
+static int failures = 0;
+
+static void check(const std::string& what, bool ok) {
+    std::cout << (ok ? "  ok    " : "  FAIL  ") << what << "\n";
+    if (!ok) failures++;
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        std::cerr << "Usage: " << argv[0] << " <data.rec> [batch]\n";
+        return 1;
+    }
+    const std::string data_path = argv[1];
+    const int batch = argc > 2 ? std::atoi(argv[2]) : 64;
+    if (batch < 1) {
+        std::cerr << "Usage: " << argv[0] << " <data.rec> [batch]\n"
+                  << "ERROR: batch must be positive\n";
+        return 1;
+    }
+
+    Dataset data;
+    if (!data.open(data_path)) return 1;
+    const std::vector<uint64_t> ref = reference(data);
+    std::cout << data.size() << " samples x " << data.num_features() << " features, batch "
+              << batch << "\n";
+
+    std::cout << "DataLoader\n";
+    {
+        DataLoader in_order(data, batch, false);
+        check("no shuffle: file order", stream(in_order, 0) == ref);
+
+        DataLoader a(data, batch, true, 7), b(data, batch, true, 7);
+        std::vector<uint64_t> first = stream(a, 0);
+        check("shuffle: every sample once", same_samples(first, ref));
+        check("shuffle: same order for the same seed", first == stream(b, 0));
+        check("shuffle: next epoch still every sample once", same_samples(stream(a, 1), ref));
+    }
+
+    std::cout << "StreamingDataset\n";
+    {
+        const size_t chunk_bytes = 64u << 10;   // several chunks even for small files
+        StreamingDataset in_order;
+        if (!in_order.open(data_path, batch, 4, chunk_bytes)) return 1;
+        std::cout << "  (" << (in_order.uses_io_uring() ? "io_uring" : "pread")
+                  << (in_order.uses_direct_io() ? ", O_DIRECT" : "") << ")\n";
+        check("no shuffle: file order", stream(in_order, 0) == ref);
+        check("no failure reported", !in_order.failed());
+
+        StreamingDataset a, b;
+        if (!a.open(data_path, batch, 4, chunk_bytes, true, 7) ||
+            !b.open(data_path, batch, 4, chunk_bytes, true, 7)) return 1;
+        std::vector<uint64_t> first = stream(a, 0);
+        check("chunk shuffle: every sample once", same_samples(first, ref));
+        check("chunk shuffle: same order for the same seed", first == stream(b, 0));
+
+        // Short reads: the file loses its second half after open()
+        namespace fs = std::filesystem;
+        const fs::path copy = fs::temp_directory_path() / "loader_check_truncated.rec";
+        fs::copy_file(data_path, copy, fs::copy_options::overwrite_existing);
+        StreamingDataset cut;
+        if (!cut.open(copy.string(), batch, 4, chunk_bytes)) return 1;
+        fs::resize_file(copy, fs::file_size(copy) / 2);
+        std::vector<uint64_t> partial = stream(cut, 0);
+        check("truncated file: epoch stops early with failed()",
+              cut.failed() && partial.size() < ref.size() &&
+              std::equal(partial.begin(), partial.end(), ref.begin()));
+        cut.close();
+        fs::remove(copy);
+    }
+
+    std::cout << "ShardedDataset\n";
+    {
+        namespace fs = std::filesystem;
+        const fs::path dir = fs::temp_directory_path() / "loader_check_shards";
+        fs::remove_all(dir);
+        fs::create_directories(dir);
+
+        const int num_shards = 5;
+        std::ofstream manifest(dir / "manifest.txt");
+        for (int s = 0; s < num_shards; ++s) {
+            const std::string name = "shard" + std::to_string(s) + ".rec";
+            DatasetWriter writer;
+            if (!writer.open((dir / name).string(), data.num_features())) return 1;
+            for (int64_t i = s; i < data.size(); i += num_shards)
+                writer.append(data.record(i), data.label(i));
+            if (!writer.close()) return 1;
+            manifest << name << "\n";
+        }
+        manifest.close();
+        const std::string manifest_path = (dir / "manifest.txt").string();
+
+        ShardedDataset a, b;
+        if (!a.open(manifest_path, batch, 3, 256, 7) ||
+            !b.open(manifest_path, batch, 3, 256, 7)) return 1;
+        std::vector<uint64_t> first = stream(a, 0);
+        check("every sample once", same_samples(first, ref));
+        check("same order for the same seed", first == stream(b, 0));
+        check("next epoch still every sample once", same_samples(stream(a, 1), ref));
+        check("no failure reported", !a.failed());
+
+        ShardedDataset missing;
+        if (!missing.open(manifest_path, batch, 3, 256, 7)) return 1;
+        fs::remove(dir / "shard3.rec");
+        std::vector<uint64_t> partial = stream(missing, 0);
+        check("deleted shard: epoch stops with failed()",
+              missing.failed() && partial.size() < ref.size());
+        fs::remove_all(dir);
+    }
+
+    if (failures) std::cout << failures << " check(s) failed\n";
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,149 @@
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <string>
+#include <cstdlib>
+#include <filesystem>
+
+#include "core/loss_functions.h"
+#include "core/optimizers.h"
+#include "core/low_rank.h"
+#include "tools/common.h"
+
+/* -------------------------------------------------
+   Low-rank factorization (truncated randomized SVD)
+
+   Usage:
+     low_rank <eval.rec> [layer=2] [rank=32] [weights_dir=weights]
+              [train.rec] [epochs=1] [lr=0.001] [out_dir=low_rank]
+
+   1. prints rank vs approximation error / MACs / accuracy for
+      dense<layer> (1-based)
+   2. factorizes dense<layer> at `rank`; with train.rec, fine-tunes
+      the factorized model with Model::fit for `epochs`
+   3. writes the factorized model's layers (dense{i}_W/_b.bin) and
+      architecture.txt (widths + activations, see load_architecture),
+      and checks the model loaded back from them
+------------------------------------------------- */
+
+// Multiply-adds per sample
+static int64_t model_macs(Model& model) {
+    int64_t macs = 0;
+    for (int l = 0; l < model.num_layers(); ++l)
+        macs += static_cast<int64_t>(model.layer(l).W.rows) * model.layer(l).W.cols;
+    return macs;
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        std::cerr << "Usage: " << argv[0]
+                  << " <eval.rec> [layer] [rank] [weights_dir] [train.rec] [epochs] [lr] [out_dir]\n";
+        return 1;
+    }
+    const std::string eval_path = argv[1];
+    const int layer = argc > 2 ? std::atoi(argv[2]) : 2;
+    const int rank = argc > 3 ? std::atoi(argv[3]) : 32;
+    const std::string weights_dir = argc > 4 ? argv[4] : "weights";
+    const std::string train_path = argc > 5 ? argv[5] : "";
+    const int epochs = argc > 6 ? std::atoi(argv[6]) : 1;
+    const float lr = argc > 7 ? static_cast<float>(std::atof(argv[7])) : 0.001f;
+    const std::string out_dir = argc > 8 ? argv[8] : "low_rank";
+
+    ReferenceNet net(weights_dir);
+    Model& model = net.model;
+
+    if (layer < 1 || layer > model.num_layers()) {
+        std::cerr << "ERROR: layer must be 1.." << model.num_layers() << std::endl;
+        return 1;
+    }
+    const Tensor& W = model.layer(layer - 1).W;
+    const int max_rank = std::min(W.rows, W.cols);
+    if (rank < 1 || rank > max_rank) {
+        std::cerr << "ERROR: rank must be 1.." << max_rank << std::endl;
+        return 1;
+    }
+
+    Dataset eval;
+    if (!eval.open(eval_path)) return 1;
+
+    const int64_t dense_macs = model_macs(model);
+    std::cout << std::fixed << std::setprecision(4)
+              << "dense" << layer << " " << W.rows << "x" << W.cols
+              << ", model " << dense_macs << " MACs/sample, accuracy "
+              << accuracy(model, eval) << ", latency " << latency_ms(model, eval) << " ms\n\n"
+              << "rank   rel_error  model_MACs  saved   accuracy  latency_ms\n";
+
+    /* -------------------------------------------------
+       1. Rank sweep
+    ------------------------------------------------- */
+    std::vector<int> sweep;
+    for (int r = 4; r < max_rank; r *= 2) sweep.push_back(r);
+    sweep.push_back(rank);
+    std::sort(sweep.begin(), sweep.end());
+    sweep.erase(std::unique(sweep.begin(), sweep.end()), sweep.end());
+
+    for (int r : sweep) {
+        std::vector<int> ranks(model.num_layers(), 0);
+        ranks[layer - 1] = r;
+        Model small;
+        factorize_model(model, ranks, small);
+
+        LowRankFactors f;
+        f.A = small.layer(layer - 1).W;
+        f.B = small.layer(layer).W;
+        int64_t macs = model_macs(small);
+
+        std::cout << std::setw(4) << r << "   " << relative_error(W, f) << "     "
+                  << std::setw(7) << macs << "   "
+                  << std::setprecision(1) << 100.0 * (dense_macs - macs) / dense_macs << "%   "
+                  << std::setprecision(4) << accuracy(small, eval) << "    "
+                  << latency_ms(small, eval) << (r == rank ? "  <-" : "") << "\n";
+    }
+
+    /* -------------------------------------------------
+       2. Factorize at `rank` (+ optional fine-tune)
+    ------------------------------------------------- */
+    std::vector<int> ranks(model.num_layers(), 0);
+    ranks[layer - 1] = rank;
+    Model small;
+    factorize_model(model, ranks, small);
+
+    if (!train_path.empty()) {
+        Dataset train;
+        if (!train.open(train_path)) return 1;
+
+        Loss loss(LossType::SPARSE_CATEGORICAL_CROSS_ENTROPY, 10);
+        SGDOptimizer opt(lr, 0.9f);
+        small.compile(loss, opt);
+
+        std::cout << "\nFine-tuning rank " << rank << " for " << epochs << " epoch(s)\n";
+        double before = accuracy(small, eval);
+        small.fit(train, epochs, 64);
+        std::cout << "Accuracy: " << before << " -> " << accuracy(small, eval) << "\n";
+    }
+
+    /* -------------------------------------------------
+       3. Write the factorized layers + architecture.txt, then
+          load them back as a check
+    ------------------------------------------------- */
+    std::filesystem::create_directories(out_dir);
+    for (int l = 0; l < small.num_layers(); ++l) {
+        std::string prefix = out_dir + "/dense" + std::to_string(l + 1);
+        save_bin(prefix + "_W.bin", small.layer(l).W.data);
+        save_bin(prefix + "_b.bin", small.layer(l).b);
+    }
+    if (!save_architecture(small, out_dir)) return 1;
+
+    Model loaded;
+    if (!load_architecture(out_dir, loaded)) return 1;
+    load_model_weights(loaded, out_dir);
+    const double small_acc = accuracy(small, eval);
+    const double loaded_acc = accuracy(loaded, eval);
+    std::cout << "Factorized model (" << small.num_layers() << " layers) written to "
+              << out_dir << "/; reloaded accuracy " << loaded_acc << "\n";
+    if (loaded_acc != small_acc) {
+        std::cerr << "ERROR: reloaded model differs (accuracy " << small_acc << ")" << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,88 @@
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <cmath>
+#include <string>
+#include <cstdlib>
+#include <algorithm>
+
+#include "core/loss_functions.h"
+#include "core/optimizers.h"
+#include "tools/common.h"
+#include "tools/alloc_counter.h"
+
+/* -------------------------------------------------
+   Static memory plan report
+
+   Usage:
+     memory_plan <train.rec> [batch_size=64] [epochs=2] [weights_dir=weights]
+
+   Prints the training memory plan of the reference model for
+   `batch_size` (buffers, arena size vs one allocation per tensor),
+   then fine-tunes two copies from the same weights, unplanned and
+   planned, and reports heap allocations per step, time, and the
+   largest weight difference (expected 0).
+------------------------------------------------- */
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        std::cerr << "Usage: " << argv[0] << " <train.rec> [batch_size] [epochs] [weights_dir]\n";
+        return 1;
+    }
+    const std::string train_path = argv[1];
+    const int batch_size = argc > 2 ? std::atoi(argv[2]) : 64;
+    const int epochs = argc > 3 ? std::atoi(argv[3]) : 2;
+    const std::string weights_dir = argc > 4 ? argv[4] : "weights";
+
+    Dataset train;
+    if (!train.open(train_path)) return 1;
+
+    Loss loss(LossType::SPARSE_CATEGORICAL_CROSS_ENTROPY, 10);
+    SGDOptimizer opt_plain(0.001f, 0.9f), opt_planned(0.001f, 0.9f);
+
+    ReferenceNet plain(weights_dir), planned(weights_dir);
+    plain.model.compile(loss, opt_plain);
+    planned.model.compile(loss, opt_planned, batch_size);
+
+    const MemoryPlan& plan = planned.model.memory_plan();
+    std::cout << std::fixed << std::setprecision(1)
+              << "Plan: " << plan.num_buffers() << " buffers, arena "
+              << plan.peak_bytes() / 1024.0 << " KiB vs "
+              << plan.unshared_bytes() / 1024.0 << " KiB unshared\n"
+              << std::defaultfloat << std::setprecision(6);
+
+    const double steps = epochs * std::ceil(static_cast<double>(train.size()) / batch_size);
+
+    std::cout << "== unplanned ==\n";
+    long a0 = allocations;
+    auto t0 = std::chrono::high_resolution_clock::now();
+    plain.model.fit(train, epochs, batch_size);
+    auto t1 = std::chrono::high_resolution_clock::now();
+    long plain_allocs = allocations - a0;
+
+    std::cout << "== planned ==\n";
+    a0 = allocations;
+    auto t2 = std::chrono::high_resolution_clock::now();
+    planned.model.fit(train, epochs, batch_size);
+    auto t3 = std::chrono::high_resolution_clock::now();
+    long planned_allocs = allocations - a0;
+
+    float max_diff = 0.0f;
+    for (int l = 0; l < plain.model.num_layers(); ++l) {
+        const std::vector<float>& a = plain.model.layer(l).W_param.data;
+        const std::vector<float>& b = planned.model.layer(l).W_param.data;
+        for (size_t i = 0; i < a.size(); ++i)
+            max_diff = std::max(max_diff, std::fabs(a[i] - b[i]));
+    }
+
+    const double plain_s = std::chrono::duration<double>(t1 - t0).count();
+    const double planned_s = std::chrono::duration<double>(t3 - t2).count();
+    std::cout << "Allocations per step: " << plain_allocs / steps << " (unplanned) vs "
+              << planned_allocs / steps << " (planned)\n"
+              << std::setprecision(3)
+              << "Training time: " << plain_s << " s vs " << planned_s << " s ("
+              << plain_s / planned_s << "x)\n"
+              << std::scientific << std::setprecision(1)
+              << "Max |weight diff|: " << max_diff << "\n";
+    return 0;
+}
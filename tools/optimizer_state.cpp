@@ -0,0 +1,143 @@
+#include <iostream>
+#include <iomanip>
+#include <memory>
+#include <vector>
+#include <string>
+#include <cmath>
+#include <cstdlib>
+#include <filesystem>
+
+#include "core/loss_functions.h"
+#include "core/optimizers.h"
+#include "tools/common.h"
+
+/* -------------------------------------------------
+   8-bit optimizer state report
+
+   Usage:
+     optimizer_state <train.rec|teacher> [epochs=1] [batch_size=64]
+                     [lr=0.0001] [weights_dir=weights]
+
+   Fine-tunes copies of the reference model from the same weights with
+   Adam and RMSProp, each with fp32 and block-wise int8 moments
+   (StatePrecision), and reports optimizer state bytes, the mean loss
+   over train.rec after training, and the relative loss difference
+   int8 vs fp32.
+
+   `teacher` trains on write_teacher_set(200000 samples, seed 7).
+
+   Before training, checks int8 Adam on two entries sharing a state
+   block: one saw a single 1e3 gradient, the other a steady 1e-4 and
+   then 0. Its v rounds to zero against the block absmax while its m
+   does not; the int8 step must stay near the fp32 step instead of
+   becoming lr * m / eps. Exits 1 if it does not.
+------------------------------------------------- */
+
+// Mean loss of `model` over every sample of `data`
+static double mean_loss(Model& model, const Dataset& data, const Loss& loss) {
+    double total = 0.0;
+    DatasetBatches batches(data, 256);
+    BatchView batch;
+    std::vector<int> labels;
+    batches.start_epoch(0);
+    while (batches.next(batch)) {
+        Tensor out = model.predict(batch);
+        labels.resize(batch.rows);
+        for (int r = 0; r < batch.rows; ++r) labels[r] = batch.label(r);
+        total += static_cast<double>(loss.forward(out, labels)) * batch.rows;
+    }
+    return data.size() > 0 ? total / data.size() : 0.0;
+}
+
+// Last step of entry 1 in the two-entry case above
+static float small_v_step(StatePrecision precision, float lr) {
+    AdamOptimizer opt(lr, 0.9f, 0.999f, 1e-8f, precision);
+    Parameter p;
+    p.data = { 0.0f, 0.0f };
+    p.grad = { 1e3f, 1e-4f };
+    opt.step(p);
+    for (int s = 0; s < 100; ++s) {
+        p.grad = { 0.0f, 1e-4f };
+        opt.step(p);
+    }
+    const float before = p.data[1];
+    p.grad = { 0.0f, 0.0f };
+    opt.step(p);
+    return p.data[1] - before;
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        std::cerr << "Usage: " << argv[0]
+                  << " <train.rec|teacher> [epochs] [batch_size] [lr] [weights_dir]\n";
+        return 1;
+    }
+    std::string train_path = argv[1];
+    const int epochs = argc > 2 ? std::atoi(argv[2]) : 1;
+    const int batch_size = argc > 3 ? std::atoi(argv[3]) : 64;
+    const float lr = argc > 4 ? static_cast<float>(std::atof(argv[4])) : 0.0001f;
+    const std::string weights_dir = argc > 5 ? argv[5] : "weights";
+
+    const float step_fp32 = small_v_step(StatePrecision::FP32, 1e-3f);
+    const float step_int8 = small_v_step(StatePrecision::INT8, 1e-3f);
+    std::cout << "small-v check: adam step fp32 " << step_fp32
+              << ", int8 " << step_int8 << "\n";
+    if (!(std::fabs(step_int8) <= 2.0f * std::fabs(step_fp32))) {
+        std::cerr << "ERROR: int8 Adam step diverges from fp32 where v rounds to zero\n";
+        return 1;
+    }
+
+    const bool teacher = train_path == "teacher";
+    if (teacher) {
+        ReferenceNet labeller(weights_dir);
+        train_path = (std::filesystem::temp_directory_path() / "optimizer_state_teacher.rec").string();
+        if (!write_teacher_set(labeller.model, train_path, 200000, 7)) return 1;
+    }
+    Dataset train;
+    if (!train.open(train_path)) return 1;
+    if (teacher) std::filesystem::remove(train_path);   // stays mapped
+
+    Loss loss(LossType::SPARSE_CATEGORICAL_CROSS_ENTROPY, 10);
+
+    struct Result {
+        size_t state_bytes;
+        double loss;
+    };
+    Result results[2][2];
+    const char* optimizers[2] = { "adam", "rmsprop" };
+    const char* precisions[2] = { "fp32", "int8" };
+
+    for (int o = 0; o < 2; ++o) {
+        for (int p = 0; p < 2; ++p) {
+            const StatePrecision precision = p ? StatePrecision::INT8 : StatePrecision::FP32;
+            std::unique_ptr<Optimizer> opt;
+            if (o == 0)
+                opt.reset(new AdamOptimizer(lr, 0.9f, 0.999f, 1e-8f, precision));
+            else
+                opt.reset(new RMSPropOptimizer(lr, 0.9f, 1e-8f, precision));
+
+            ReferenceNet net(weights_dir);
+            net.model.compile(loss, *opt);
+            std::cout << "== " << optimizers[o] << ", " << precisions[p] << " state ==\n";
+            net.model.fit(train, epochs, batch_size);
+            results[o][p] = { opt->state_bytes(), mean_loss(net.model, train, loss) };
+        }
+    }
+
+    std::cout << std::fixed << std::setprecision(1)
+              << "\noptimizer  state   state KB   loss after training\n";
+    for (int o = 0; o < 2; ++o) {
+        for (int p = 0; p < 2; ++p)
+            std::cout << std::setw(9) << std::left << optimizers[o] << std::right << "  "
+                      << precisions[p] << "   " << std::setw(8) << results[o][p].state_bytes / 1000.0
+                      << "   " << std::setprecision(6) << results[o][p].loss
+                      << std::setprecision(1) << "\n";
+        const Result& fp32 = results[o][0];
+        const Result& int8 = results[o][1];
+        std::cout << "  int8: " << static_cast<double>(fp32.state_bytes) / int8.state_bytes
+                  << "x less state, loss " << std::showpos << std::setprecision(3)
+                  << 100.0 * (int8.loss - fp32.loss) / fp32.loss << "%"
+                  << std::noshowpos << std::setprecision(1) << " vs fp32\n";
+    }
+    return 0;
+}
@@ -0,0 +1,198 @@
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <algorithm>
+#include <string>
+#include <cstdlib>
+#include <filesystem>
+#include <memory>
+
+#include "core/loss_functions.h"
+#include "core/optimizers.h"
+#include "core/sparse_weights.h"
+#include "tools/common.h"
+
+/* -------------------------------------------------
+   Magnitude pruning
+
+   Usage:
+     prune_model <eval.rec> [sparsity=0.9] [block=8]
+                 [weights_dir=weights] [out_dir=pruned]
+                 [train.rec] [epochs=1] [lr=0.0005]
+
+   1. prunes every layer's W to `sparsity` (1 x 8 tiles, or single
+      weights with block=1)
+   2. with train.rec, fine-tunes with the pruned entries kept at zero
+      (DenseLayer::weight_mask)
+   3. switches layers to the block-sparse kernel with
+      set_sparse_weights (only those sparse enough to win)
+   4. reports per-layer weight / tile / input sparsity, bytes, the
+      kernel each layer runs, and batch-1 DenseLayer::forward time on
+      the same input for
+        dense        fp32 W, every input multiplied (gemm)
+        act-skip     fp32 W, rows of W skipped for zero inputs
+        weight-sp    block-sparse W, input zeros filled in
+        both         block-sparse W, the real input
+      (so weight and activation sparsity show separately), and model
+      accuracy dense / pruned / fine-tuned
+   5. writes the pruned weights (dense .bin files, zeros included)
+      for load_model_weights + set_sparse_weights
+------------------------------------------------- */
+
+// Mean DenseLayer::forward time for x, in microseconds
+static double forward_us(DenseLayer& layer, const Tensor& x, const BitMask* nz) {
+    Tensor y;
+    return time_us([&] { layer.forward_borrowed(x, nz, y); }, 2000);
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        std::cerr << "Usage: " << argv[0]
+                  << " <eval.rec> [sparsity] [block] [weights_dir] [out_dir]"
+                     " [train.rec] [epochs] [lr]\n";
+        return 1;
+    }
+    const std::string eval_path = argv[1];
+    const float sparsity = argc > 2 ? static_cast<float>(std::atof(argv[2])) : 0.9f;
+    const int block = argc > 3 ? std::atoi(argv[3]) : SPARSE_BLOCK;
+    const std::string weights_dir = argc > 4 ? argv[4] : "weights";
+    const std::string out_dir = argc > 5 ? argv[5] : "pruned";
+    const std::string train_path = argc > 6 ? argv[6] : "";
+    const int epochs = argc > 7 ? std::atoi(argv[7]) : 1;
+    const float lr = argc > 8 ? static_cast<float>(std::atof(argv[8])) : 0.0005f;
+
+    if (block != 1 && block != SPARSE_BLOCK) {
+        std::cerr << "ERROR: block must be 1 or " << SPARSE_BLOCK << std::endl;
+        return 1;
+    }
+
+    ReferenceNet net(weights_dir);
+    Model& model = net.model;
+
+    Dataset eval;
+    if (!eval.open(eval_path)) return 1;
+
+    EvalRun dense = run_eval(model, eval);
+
+    // Each layer's input for one eval sample in the unpruned model
+    // (hidden layers: RELU activations with their zeros)
+    model.predict(eval.batch(0, 1));
+    std::vector<Tensor> inputs;
+    for (int l = 0; l < model.num_layers(); ++l) {
+        const DenseLayer& layer = model.layer(l);
+        Tensor x(1, layer.W.rows);
+        std::copy(layer.input_ptr, layer.input_ptr + layer.W.rows, x.data.begin());
+        inputs.push_back(x);
+    }
+
+    /* -------------------------------------------------
+       1. Prune
+    ------------------------------------------------- */
+    for (int l = 0; l < model.num_layers(); ++l)
+        magnitude_prune(model.layer(l), sparsity, block);
+
+    EvalRun pruned = run_eval(model, eval);
+
+    /* -------------------------------------------------
+       2. Fine-tune with the pruned entries kept at zero
+    ------------------------------------------------- */
+    if (!train_path.empty()) {
+        Dataset train;
+        if (!train.open(train_path)) return 1;
+
+        Loss loss(LossType::SPARSE_CATEGORICAL_CROSS_ENTROPY, 10);
+        SGDOptimizer opt(lr, 0.9f);
+        model.compile(loss, opt);
+        model.fit(train, epochs, 64);
+
+        for (int l = 0; l < model.num_layers(); ++l) {
+            const DenseLayer& layer = model.layer(l);
+            for (size_t i = 0; i < layer.W.data.size(); ++i) {
+                if (layer.weight_mask[i] == 0.0f && layer.W.data[i] != 0.0f) {
+                    std::cerr << "ERROR: dense" << l + 1 << " lost its pruned weights" << std::endl;
+                    return 1;
+                }
+            }
+        }
+    }
+
+    /* -------------------------------------------------
+       3. Block-sparse kernel where it wins
+    ------------------------------------------------- */
+    const int switched = set_sparse_weights(model);
+    EvalRun sparse = run_eval(model, eval);
+
+    /* -------------------------------------------------
+       4. Report
+    ------------------------------------------------- */
+    std::cout << std::fixed << std::setprecision(3)
+              << "Layer   shape     sparsity: weights  tiles  input   bytes dense -> sparse   kernel\n";
+    for (int l = 0; l < model.num_layers(); ++l) {
+        const DenseLayer& layer = model.layer(l);
+        const float input_zeros =
+            static_cast<float>(std::count(inputs[l].data.begin(), inputs[l].data.end(), 0.0f)) /
+            layer.W.rows;
+        std::cout << "dense" << l + 1 << "  " << std::setw(3) << layer.W.rows << "x"
+                  << std::setw(3) << layer.W.cols << "             "
+                  << weight_sparsity(layer.W) << "  " << block_sparsity(layer.W) << "  "
+                  << input_zeros << "   "
+                  << std::setw(6) << layer.W.data.size() * sizeof(float) << " -> "
+                  << std::setw(6) << BlockSparseWeights(layer.W).bytes() << "   "
+                  << (layer.packed ? "sparse" : "dense") << "\n";
+    }
+    std::cout << switched << " of " << model.num_layers()
+              << " layers on the block-sparse kernel (set_sparse_weights)\n";
+
+    std::cout << "\nBatch-1 forward us   dense   act-skip   weight-sp     both\n";
+    for (int l = 0; l < model.num_layers(); ++l) {
+        DenseLayer& layer = model.layer(l);
+        const Tensor& x = inputs[l];
+        BitMask nz;   // hidden inputs are RELU outputs: non-zero == positive
+        nz.build_positive(x.data.data(), 1, layer.W.rows, layer.W.rows);
+
+        // The sparse kernel always skips zero inputs: time it once on
+        // x with its zeros filled in (weight sparsity alone)
+        Tensor filled = x;
+        for (float& v : filled.data)
+            if (v == 0.0f) v = 0.01f;
+
+        // Time both paths whichever one set_sparse_weights picked
+        std::unique_ptr<PackedWeights> chosen = std::move(layer.packed);
+        const float threshold = layer.sparse_input_threshold;
+        const double dense_us = forward_us(layer, x, nullptr);
+        layer.sparse_input_threshold = 1.01f;   // masked path at any density
+        const double skip_us = l > 0 ? forward_us(layer, x, &nz) : 0.0;
+        layer.sparse_input_threshold = threshold;
+        layer.packed.reset(new BlockSparseWeights(layer.W));
+        const double weight_us = forward_us(layer, filled, nullptr);
+        const double both_us = forward_us(layer, x, nullptr);
+        layer.packed = std::move(chosen);
+
+        std::cout << "dense" << l + 1 << "            " << std::setw(9) << dense_us << "   ";
+        if (l > 0)
+            std::cout << std::setw(8) << skip_us << "   ";
+        else
+            std::cout << "       -   ";   // raw features: no RELU zeros to skip
+        std::cout << std::setw(9) << weight_us << "   "
+                  << std::setw(6) << both_us << "\n";
+    }
+    std::cout << "\n";
+
+    std::cout << "Accuracy: " << dense.accuracy() << " (dense) -> "
+              << pruned.accuracy() << " (pruned)";
+    if (!train_path.empty())
+        std::cout << " -> " << sparse.accuracy() << " (fine-tuned)";
+    std::cout << ", agreement " << sparse.agreement(dense) << "\n";
+
+    /* -------------------------------------------------
+       5. Write pruned weights
+    ------------------------------------------------- */
+    std::filesystem::create_directories(out_dir);
+    for (int l = 0; l < model.num_layers(); ++l) {
+        std::string prefix = out_dir + "/dense" + std::to_string(l + 1);
+        save_bin(prefix + "_W.bin", model.layer(l).W.data);
+        save_bin(prefix + "_b.bin", model.layer(l).b);
+    }
+    std::cout << "Pruned weights written to " << out_dir << "/\n";
+    return 0;
+}
@@ -0,0 +1,97 @@
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <string>
+#include <cmath>
+#include <cstdlib>
+#include <filesystem>
+
+#include "core/structured_pruning.h"
+#include "tools/common.h"
+
+/* -------------------------------------------------
+   Structured (neuron) pruning
+
+   Usage:
+     prune_neurons <calib.rec> [eval.rec] [keep=0.75]
+                   [weights_dir=weights] [out_dir=pruned_neurons]
+
+   1. ranks hidden units by saliency on calib.rec
+   2. prints the accuracy / latency curve for hidden widths scaled by
+      1.0, 0.875, ..., 0.25
+   3. writes the model at `keep` (e.g. 0.75 -> 80-192-96-48-10):
+      dense{i}_W.bin / _b.bin plus architecture.txt (layer widths,
+      see load_architecture)
+------------------------------------------------- */
+
+static size_t num_params(Model& model) {
+    size_t total = 0;
+    for (int l = 0; l < model.num_layers(); ++l)
+        total += model.layer(l).W.data.size() + model.layer(l).b.size();
+    return total;
+}
+
+static std::vector<int> scaled_widths(Model& model, float keep) {
+    std::vector<int> widths;
+    for (int l = 0; l + 1 < model.num_layers(); ++l)
+        widths.push_back(std::max(1, static_cast<int>(std::lround(model.layer(l).W.cols * keep))));
+    return widths;
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        std::cerr << "Usage: " << argv[0]
+                  << " <calib.rec> [eval.rec] [keep] [weights_dir] [out_dir]\n";
+        return 1;
+    }
+    const std::string calib_path = argv[1];
+    const std::string eval_path = argc > 2 ? argv[2] : calib_path;
+    const float keep = argc > 3 ? static_cast<float>(std::atof(argv[3])) : 0.75f;
+    const std::string weights_dir = argc > 4 ? argv[4] : "weights";
+    const std::string out_dir = argc > 5 ? argv[5] : "pruned_neurons";
+
+    ReferenceNet net(weights_dir);
+    Model& model = net.model;
+
+    Dataset calib, eval;
+    if (!calib.open(calib_path) || !eval.open(eval_path)) return 1;
+
+    DatasetBatches calib_batches(calib, 256);
+    NeuronStats stats = neuron_stats(model, calib_batches);
+
+    /* -------------------------------------------------
+       1. Trade-off curve
+    ------------------------------------------------- */
+    std::cout << std::fixed << std::setprecision(4)
+              << "keep   widths            params   accuracy  latency_ms\n";
+    for (float k : { 1.0f, 0.875f, 0.75f, 0.625f, 0.5f, 0.375f, 0.25f }) {
+        Model small;
+        std::vector<int> widths = scaled_widths(model, k);
+        shrink_model(model, stats, widths, small);
+
+        std::string shape = std::to_string(small.layer(0).W.rows);
+        for (int l = 0; l < small.num_layers(); ++l)
+            shape += "-" + std::to_string(small.layer(l).W.cols);
+
+        std::cout << std::setprecision(3) << k << "  " << std::left << std::setw(16) << shape
+                  << std::right << std::setw(8) << num_params(small) << "   "
+                  << std::setprecision(4) << accuracy(small, eval) << "    "
+                  << latency_ms(small, eval) << "\n";
+    }
+
+    /* -------------------------------------------------
+       2. Write the model at `keep`
+    ------------------------------------------------- */
+    Model small;
+    shrink_model(model, stats, scaled_widths(model, keep), small);
+
+    std::filesystem::create_directories(out_dir);
+    for (int l = 0; l < small.num_layers(); ++l) {
+        std::string prefix = out_dir + "/dense" + std::to_string(l + 1);
+        save_bin(prefix + "_W.bin", small.layer(l).W.data);
+        save_bin(prefix + "_b.bin", small.layer(l).b);
+    }
+    if (!save_architecture(small, out_dir)) return 1;
+    std::cout << "Pruned model (keep " << keep << ") written to " << out_dir << "/\n";
+    return 0;
+}
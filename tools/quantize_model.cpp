@@ -0,0 +1,140 @@
+#include <iostream>
+#include <fstream>
+#include <iomanip>
+#include <vector>
+#include <string>
+#include <filesystem>
+
+#include "core/quantization.h"
+#include "core/quantized_model.h"
+#include "tools/common.h"
+
+/* -------------------------------------------------
+   Post-training int8 quantization
+
+   Usage:
+     quantize_model <calib.rec> [eval.rec] [weights_dir=weights]
+                    [out_dir=quantized] [calib_batches=100]
+
+   1. calibrates activation ranges on calib.rec
+   2. quantizes all layers (per-channel int8 weights)
+   3. reports int8 vs fp32 accuracy / agreement / latency on eval.rec,
+      for both the int8 GEMM path (fp32 between layers) and the
+      integer-only QuantizedModel engine
+   4. writes int8 weights, weight scales and activation scales
+------------------------------------------------- */
+
+// Samples timed for batch-1 latency
+static const int LAT_N = 200;
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        std::cerr << "Usage: " << argv[0]
+                  << " <calib.rec> [eval.rec] [weights_dir] [out_dir] [calib_batches]\n";
+        return 1;
+    }
+    const std::string calib_path = argv[1];
+    const std::string eval_path = argc > 2 ? argv[2] : calib_path;
+    const std::string weights_dir = argc > 3 ? argv[3] : "weights";
+    const std::string out_dir = argc > 4 ? argv[4] : "quantized";
+    const int calib_batches = argc > 5 ? std::atoi(argv[5]) : 100;
+
+    ReferenceNet net(weights_dir);
+    Model& model = net.model;
+
+    Dataset calib, eval;
+    if (!calib.open(calib_path) || !eval.open(eval_path)) return 1;
+
+    /* -------------------------------------------------
+       1. fp32 baseline
+    ------------------------------------------------- */
+    EvalRun fp32 = run_eval(model, eval);
+    double fp32_ms = latency_ms(model, eval, LAT_N);
+
+    /* -------------------------------------------------
+       2. Calibrate + quantize
+    ------------------------------------------------- */
+    Calibrator calibrator(model);
+    DatasetBatches calib_batches_src(calib, 256);
+    calibrator.observe(calib_batches_src, calib_batches);
+    quantize_model(model, calibrator.input_ranges());
+
+    EvalRun int8 = run_eval(model, eval);
+    double int8_ms = latency_ms(model, eval, LAT_N);
+
+    QuantizedModel int_only;
+    if (!int_only.build(model, calibrator.input_ranges())) return 1;
+
+    int64_t int_only_correct = 0, int_only_agree = 0;
+    for (int64_t i = 0; i < eval.size(); ++i) {
+        int p = int_only.predict_class(eval.record(i));
+        if (p == eval.label(i)) int_only_correct++;
+        if (p == fp32.predictions[i]) int_only_agree++;
+    }
+    const int lat_n = static_cast<int>(std::min<int64_t>(LAT_N, eval.size()));
+    int next_sample = 0;
+    double int_only_ms = time_us([&] {
+        int_only.predict_class(eval.record(next_sample++ % lat_n));
+    }, lat_n) / 1000.0;
+
+    /* -------------------------------------------------
+       3. Report
+    ------------------------------------------------- */
+    float max_diff = 0.0f;
+    double sum_diff = 0.0;
+    for (size_t i = 0; i < fp32.outputs.size(); ++i) {
+        float d = std::fabs(fp32.outputs[i] - int8.outputs[i]);
+        max_diff = std::max(max_diff, d);
+        sum_diff += d;
+    }
+    const double n = static_cast<double>(eval.size());
+
+    size_t fp32_bytes = 0, int8_bytes = 0;
+    for (int l = 0; l < model.num_layers(); ++l) {
+        fp32_bytes += model.layer(l).W.data.size() * sizeof(float);
+        int8_bytes += model.layer(l).packed->bytes();
+    }
+
+    std::cout << std::fixed << std::setprecision(4)
+              << "Samples            : " << eval.size() << "\n"
+              << "FP32 accuracy      : " << fp32.accuracy() << "\n"
+              << "INT8 accuracy      : " << int8.accuracy() << "\n"
+              << "Top-1 agreement    : " << int8.agreement(fp32) << "\n"
+              << "Output |diff| mean : " << sum_diff / fp32.outputs.size()
+              << "  max: " << max_diff << "\n"
+              << "Weight bytes       : " << fp32_bytes << " -> " << int8_bytes << "\n"
+              << "Batch-1 latency    : " << fp32_ms << " ms -> " << int8_ms << " ms\n"
+              << "Activation qmax    : " << INT8_ACT_QMAX << "\n"
+              << "Integer-only engine: accuracy " << int_only_correct / n
+              << ", agreement " << int_only_agree / n
+              << ", latency " << int_only_ms << " ms, "
+              << int_only.bytes() << " bytes\n";
+
+    /* -------------------------------------------------
+       4. Emit int8 weights + scales
+    ------------------------------------------------- */
+    std::filesystem::create_directories(out_dir);
+    std::ofstream act(out_dir + "/activation_scales.txt");
+    act << "# layer_input scale zero_point qmax\n";
+
+    for (int l = 0; l < model.num_layers(); ++l) {
+        const DenseLayer& layer = model.layer(l);
+        const Int8Weights& q = static_cast<const Int8Weights&>(*layer.packed);
+        std::string prefix = out_dir + "/dense" + std::to_string(l + 1);
+
+        std::vector<int8_t> w(layer.W.data.size());
+        for (int k = 0; k < layer.W.rows; ++k)
+            for (int j = 0; j < layer.W.cols; ++j)
+                w[static_cast<size_t>(k) * layer.W.cols + j] = q.weight(k, j);
+
+        std::ofstream fw(prefix + "_W_int8.bin", std::ios::binary);
+        fw.write(reinterpret_cast<const char*>(w.data()), w.size());
+        save_bin(prefix + "_W_scales.bin", q.channel_scales());
+
+        const QuantParams& p = q.input_params();
+        act << "dense" << l + 1 << " " << std::setprecision(9) << p.scale
+            << " " << p.zero_point << " " << p.qmax << "\n";
+    }
+    std::cout << "Quantized weights and scales written to " << out_dir << "/\n";
+    return 0;
+}
@@ -0,0 +1,164 @@
+#include <iostream>
+#include <iomanip>
+#include <random>
+#include <vector>
+#include <string>
+#include <cmath>
+#include <cstdlib>
+#include <filesystem>
+
+#include "core/sparse_tensor.h"
+#include "core/loss_functions.h"
+#include "core/optimizers.h"
+#include "tools/common.h"
+
+/* -------------------------------------------------
+   Sparse (CSR) model inputs
+
+   Usage:
+     sparse_input <eval.rec> [batch=64] [weights_dir=weights]
+
+   Zeroes a random share of each eval sample's features to reach a
+   target density, then times the first layer (dense1, 80 x 256) on
+   dense vs CSR input:
+     forward            X * W  vs  gather of W rows per non-zero
+     forward+backward   adds dW = X^T dOut (row-sparse for CSR)
+   for batch 1 and `batch`, and checks the model outputs agree.
+
+   Then trains two copies of the reference model for one epoch on
+   the eval set thinned to 5% density, one through
+   Model::fit(Dataset) on the dense rows and one through
+   Model::fit(SparseTensor), with SGD and with momentum SGD, and
+   reports the largest weight / bias difference (expected 0; exits
+   non-zero otherwise).
+------------------------------------------------- */
+
+// Rows of `data` with each feature kept with probability `density`
+static Tensor thinned(const Dataset& data, int64_t rows, float density, unsigned seed) {
+    const int K = data.num_features();
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<float> keep(0.0f, 1.0f);
+    Tensor X(static_cast<int>(rows), K);
+    for (int64_t i = 0; i < rows; ++i) {
+        const float* x = data.record(i);
+        for (int k = 0; k < K; ++k)
+            X(static_cast<int>(i), k) = keep(rng) < density ? x[k] : 0.0f;
+    }
+    return X;
+}
+
+// Largest |difference| over every layer's weights and biases
+static float max_param_diff(Model& a, Model& b) {
+    float d = 0.0f;
+    for (int l = 0; l < a.num_layers(); ++l) {
+        const DenseLayer& la = a.layer(l);
+        const DenseLayer& lb = b.layer(l);
+        for (size_t i = 0; i < la.W_param.data.size(); ++i)
+            d = std::max(d, std::fabs(la.W_param.data[i] - lb.W_param.data[i]));
+        for (size_t i = 0; i < la.b_param.data.size(); ++i)
+            d = std::max(d, std::fabs(la.b_param.data[i] - lb.b_param.data[i]));
+    }
+    return d;
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        std::cerr << "Usage: " << argv[0] << " <eval.rec> [batch] [weights_dir]\n";
+        return 1;
+    }
+    const std::string eval_path = argv[1];
+    const int batch = argc > 2 ? std::atoi(argv[2]) : 64;
+    const std::string weights_dir = argc > 3 ? argv[3] : "weights";
+
+    ReferenceNet net(weights_dir);
+    Model& model = net.model;
+
+    Dataset eval;
+    if (!eval.open(eval_path)) return 1;
+    const int K = eval.num_features();
+    if (eval.size() < batch) {
+        std::cerr << "ERROR: need at least " << batch << " samples" << std::endl;
+        return 1;
+    }
+
+    std::cout << std::fixed << std::setprecision(3)
+              << "density  rows   fwd dense us   fwd csr us   speedup   "
+                 "fwd+bwd dense us   fwd+bwd csr us   speedup   max |diff|\n";
+
+    for (float density : { 0.02f, 0.05f, 0.1f, 0.25f, 0.5f, 1.0f }) {
+        Tensor X = thinned(eval, batch, density, static_cast<unsigned>(density * 1000));
+        SparseTensor S = SparseTensor::from_dense(X);
+
+        // Full model outputs agree
+        Tensor dense_out = model.predict(X);
+        Tensor sparse_out = model.predict(S);
+        float max_diff = 0.0f;
+        for (size_t j = 0; j < dense_out.data.size(); ++j)
+            max_diff = std::max(max_diff, std::fabs(dense_out.data[j] - sparse_out.data[j]));
+
+        for (int rows : { 1, batch }) {
+            SparseTensor Sr = S.slice_rows(0, rows);
+            Tensor dOut(rows, net.d1.W.cols);
+            for (size_t j = 0; j < dOut.data.size(); ++j) dOut.data[j] = 0.001f;
+            const int iters = rows == 1 ? 20000 : 500;
+
+            double fwd_dense = time_us([&] { net.d1.forward(X.data.data(), rows, K); }, iters);
+            double fwd_sparse = time_us([&] { net.d1.forward(Sr); }, iters);
+            double train_dense = time_us([&] {
+                net.d1.forward(X.data.data(), rows, K);
+                net.d1.backward(dOut);
+            }, iters);
+            double train_sparse = time_us([&] {
+                net.d1.forward(Sr);
+                net.d1.backward(dOut);
+            }, iters);
+
+            std::cout << std::setw(7) << density << "  " << std::setw(4) << rows << "   "
+                      << std::setw(12) << fwd_dense << "   " << std::setw(10) << fwd_sparse << "   "
+                      << std::setw(6) << fwd_dense / fwd_sparse << "x   "
+                      << std::setw(16) << train_dense << "   " << std::setw(14) << train_sparse << "   "
+                      << std::setw(6) << train_dense / train_sparse << "x   "
+                      << std::scientific << std::setprecision(1) << max_diff
+                      << std::fixed << std::setprecision(3) << "\n";
+        }
+    }
+
+    /* -------------------------------------------------
+       Training: dense rows vs CSR, same samples and batches
+    ------------------------------------------------- */
+    const float train_density = 0.05f;
+    Tensor X = thinned(eval, eval.size(), train_density, 5);
+    std::vector<int> labels(eval.size());
+    for (int64_t i = 0; i < eval.size(); ++i) labels[i] = eval.label(i);
+
+    // Model::fit(Dataset) reads records: the dense rows go through a file
+    const std::string dense_path =
+        (std::filesystem::temp_directory_path() / "sparse_input_train.rec").string();
+    DatasetWriter writer;
+    if (!writer.open(dense_path, K)) return 1;
+    for (int i = 0; i < X.rows; ++i) writer.append(&X.data[static_cast<size_t>(i) * K], labels[i]);
+    if (!writer.close()) return 1;
+    Dataset train;
+    if (!train.open(dense_path)) return 1;
+    std::filesystem::remove(dense_path);   // stays mapped
+    const SparseTensor S = SparseTensor::from_dense(X);
+
+    Loss loss(LossType::SPARSE_CATEGORICAL_CROSS_ENTROPY, 10);
+    float diffs[2];
+    for (int momentum = 0; momentum < 2; ++momentum) {
+        const float m = momentum ? 0.9f : 0.0f;
+        SGDOptimizer opt_dense(0.01f, m), opt_sparse(0.01f, m);
+        ReferenceNet dense(weights_dir), sparse(weights_dir);
+        dense.model.compile(loss, opt_dense);
+        sparse.model.compile(loss, opt_sparse);
+        std::cout << "\n== " << (momentum ? "momentum SGD" : "SGD") << ": dense, then CSR ==\n";
+        dense.model.fit(train, 1, batch);
+        sparse.model.fit(S, labels, 1, batch);
+        diffs[momentum] = max_param_diff(dense.model, sparse.model);
+    }
+    std::cout << "\nTraining " << X.rows << " samples at density " << train_density
+              << ", batch " << batch << ": max |weight diff| dense vs CSR "
+              << std::scientific << std::setprecision(1)
+              << diffs[0] << " (SGD), " << diffs[1] << " (momentum SGD)\n";
+    return (diffs[0] == 0.0f && diffs[1] == 0.0f) ? 0 : 1;
+}
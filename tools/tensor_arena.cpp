@@ -0,0 +1,94 @@
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include <memory>
+#include <string>
+#include <cstdlib>
+
+#include "tools/common.h"
+#include "tools/alloc_counter.h"
+
+/* -------------------------------------------------
+   Per-thread tensor arenas in multi-threaded serving
+
+   Usage:
+     tensor_arena <eval.rec> [max_threads=8] [requests=20000] [weights_dir=weights]
+
+   Each thread serves its own copy of the reference model. For 1, 2,
+   4 ... max_threads threads and batch 1 / 64, every thread runs
+   `requests` forward passes (batch 64: requests / 16) either with
+   temporaries on the heap (layers driven directly, no arena scope) or
+   through Model::predict (thread's arena), and the tool reports
+   aggregate throughput and heap allocations per pass.
+------------------------------------------------- */
+
+// Model::predict's forward pass without an arena scope
+static Tensor predict_heap(Model& model, const Tensor& x) {
+    Tensor y = model.layer(0).forward_borrowed(x);
+    for (int l = 1; l < model.num_layers(); ++l)
+        y = model.layer(l).forward(std::move(y), model.layer(l - 1).activation.output_nonzeros());
+    return y;
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        std::cerr << "Usage: " << argv[0] << " <eval.rec> [max_threads] [requests] [weights_dir]\n";
+        return 1;
+    }
+    const std::string eval_path = argv[1];
+    const int max_threads = argc > 2 ? std::atoi(argv[2]) : 8;
+    const int requests = argc > 3 ? std::atoi(argv[3]) : 20000;
+    const std::string weights_dir = argc > 4 ? argv[4] : "weights";
+
+    Dataset eval;
+    if (!eval.open(eval_path)) return 1;
+    const int K = eval.num_features();
+
+    std::cout << std::fixed << std::setprecision(1)
+              << "threads  rows   heap passes/s   arena passes/s   speedup   allocs/pass heap   arena\n";
+
+    for (int rows : { 1, 64 }) {
+        Tensor x(rows, K);
+        for (int i = 0; i < rows; ++i)
+            std::copy(eval.record(i), eval.record(i) + K, &x.data[static_cast<size_t>(i) * K]);
+        const int passes = rows == 1 ? requests : std::max(1, requests / 16);
+
+        for (int threads = 1; threads <= max_threads; threads *= 2) {
+            std::vector<std::unique_ptr<ReferenceNet>> nets;
+            for (int t = 0; t < threads; ++t) nets.emplace_back(new ReferenceNet(weights_dir));
+
+            double rate[2];
+            long allocs[2];
+            for (int arena = 0; arena < 2; ++arena) {
+                auto serve = [&](ReferenceNet& net) {
+                    for (int r = 0; r < passes; ++r) {
+                        Tensor y = arena ? net.model.predict(x) : predict_heap(net.model, x);
+                        if (y.data[0] < 0.0f) std::abort();
+                    }
+                };
+                for (auto& net : nets) serve(*net);   // warm-up (layer caches)
+
+                const long a0 = allocations;
+                auto start = std::chrono::high_resolution_clock::now();
+                std::vector<std::thread> pool;
+                for (int t = 0; t < threads; ++t) pool.emplace_back(serve, std::ref(*nets[t]));
+                for (auto& th : pool) th.join();
+                auto end = std::chrono::high_resolution_clock::now();
+
+                rate[arena] = static_cast<double>(threads) * passes /
+                              std::chrono::duration<double>(end - start).count();
+                allocs[arena] = allocations - a0;
+            }
+
+            const double total = static_cast<double>(threads) * passes;
+            std::cout << std::setw(7) << threads << "  " << std::setw(4) << rows << "   "
+                      << std::setw(13) << rate[0] << "   " << std::setw(14) << rate[1] << "   "
+                      << std::setw(6) << rate[1] / rate[0] << "x   "
+                      << std::setw(16) << allocs[0] / total << "   "
+                      << std::setw(5) << allocs[1] / total << "\n";
+        }
+    }
+    return 0;
+}
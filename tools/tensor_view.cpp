@@ -0,0 +1,95 @@
+#include <iostream>
+#include <iomanip>
+#include <random>
+#include <vector>
+#include <string>
+#include <cmath>
+#include <cstdlib>
+
+#include "tools/common.h"
+
+/* -------------------------------------------------
+   Strided tensor views
+
+   Usage:
+     tensor_view <eval.rec> [batch=256] [weights_dir=weights]
+
+   1. Row slices: predicts `batch` eval rows in chunks of 64 taken
+      as views of one dataset batch (no copy) and checks them against
+      predicting each chunk from the dataset directly.
+   2. Transposed operands: times the two backward GEMMs of a
+      (batch x 256) -> 128 layer with the transpose materialised
+      vs read through a transposed view (gemm_tn / gemm_nt):
+        dW = X^T * G     dX = G * W^T
+------------------------------------------------- */
+
+static float max_diff(const Tensor& a, const Tensor& b) {
+    float d = 0.0f;
+    for (size_t i = 0; i < a.data.size(); ++i)
+        d = std::max(d, std::fabs(a.data[i] - b.data[i]));
+    return d;
+}
+
+static Tensor random_tensor(int rows, int cols, std::mt19937& rng) {
+    std::normal_distribution<float> dist(0.0f, 1.0f);
+    Tensor t(rows, cols);
+    for (float& v : t.data) v = dist(rng);
+    return t;
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        std::cerr << "Usage: " << argv[0] << " <eval.rec> [batch] [weights_dir]\n";
+        return 1;
+    }
+    const std::string eval_path = argv[1];
+    const int batch = argc > 2 ? std::atoi(argv[2]) : 256;
+    const std::string weights_dir = argc > 3 ? argv[3] : "weights";
+
+    ReferenceNet net(weights_dir);
+    Model& model = net.model;
+
+    Dataset eval;
+    if (!eval.open(eval_path)) return 1;
+
+    // 1. Row slices of one mapped batch
+    const BatchView rows = eval.batch(0, batch);
+    const int chunk = 64;
+    float slice_diff = 0.0f;
+    for (int start = 0; start < rows.rows; start += chunk) {
+        const int count = std::min(chunk, rows.rows - start);
+        Tensor from_view = model.predict(rows.view().slice_rows(start, count));
+        Tensor from_dataset = model.predict(eval.batch(start, count));
+        slice_diff = std::max(slice_diff, max_diff(from_view, from_dataset));
+    }
+    std::cout << "Row slices of a " << rows.rows << "-row batch vs dataset batches: max |diff| "
+              << std::scientific << std::setprecision(1) << slice_diff << "\n\n";
+
+    // 2. Transposed operands
+    std::mt19937 rng(42);
+    const int K = net.d2.W.rows, N = net.d2.W.cols;
+    Tensor X = random_tensor(rows.rows, K, rng);
+    Tensor G = random_tensor(rows.rows, N, rng);
+    const int iters = 50;
+
+    Tensor dW_copy = matmul(transpose(X), G);
+    Tensor dW_view = matmul(X.view().transposed(), G);
+    Tensor dX_copy = matmul(G, transpose(net.d2.W));
+    Tensor dX_view = matmul(G, net.d2.W.view().transposed());
+
+    const double dW_copy_us = time_us([&] { matmul(transpose(X), G); }, iters);
+    const double dW_view_us = time_us([&] { matmul(X.view().transposed(), G); }, iters);
+    const double dX_copy_us = time_us([&] { matmul(G, transpose(net.d2.W)); }, iters);
+    const double dX_view_us = time_us([&] { matmul(G, net.d2.W.view().transposed()); }, iters);
+
+    std::cout << std::fixed << std::setprecision(1)
+              << "GEMM          transpose us   view us   speedup   max |diff|\n";
+    std::cout << "dW = X^T G    " << std::setw(12) << dW_copy_us << "   " << std::setw(7) << dW_view_us
+              << "   " << std::setprecision(2) << std::setw(6) << dW_copy_us / dW_view_us << "x   "
+              << std::scientific << std::setprecision(1) << max_diff(dW_copy, dW_view) << "\n";
+    std::cout << std::fixed << std::setprecision(1)
+              << "dX = G W^T    " << std::setw(12) << dX_copy_us << "   " << std::setw(7) << dX_view_us
+              << "   " << std::setprecision(2) << std::setw(6) << dX_copy_us / dX_view_us << "x   "
+              << std::scientific << std::setprecision(1) << max_diff(dX_copy, dX_view) << "\n";
+    return 0;
+}
@@ -0,0 +1,69 @@
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <string>
+#include <filesystem>
+
+#include "core/weight_quantization.h"
+#include "tools/common.h"
+
+/* -------------------------------------------------
+   Weight-only quantization (no calibration data)
+
+   Usage:
+     weight_only <eval.rec|teacher> [weights_dir=weights]
+
+   Loads the reference model for inference with each weight storage
+   (fp32, fp16, bf16, int8, int4: load_model_weights(storage,
+   inference_only)) and reports the bytes of the weights forward()
+   reads, the resident weight bytes of the whole model (fp32 W,
+   optimizer copies and gradients are freed, see
+   Model::release_for_inference), accuracy, top-1 agreement with fp32
+   and batch-1 latency on eval.rec.
+
+   `teacher` evaluates on write_teacher_set(5000 samples, seed 12):
+   fp32 scores 1.0 and accuracy equals agreement; this is the set
+   behind the int8 / int4 figures quoted for weight-only storage.
+------------------------------------------------- */
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        std::cerr << "Usage: " << argv[0] << " <eval.rec|teacher> [weights_dir]\n";
+        return 1;
+    }
+    std::string eval_path = argv[1];
+    const std::string weights_dir = argc > 2 ? argv[2] : "weights";
+
+    const bool teacher = eval_path == "teacher";
+    if (teacher) {
+        ReferenceNet labeller(weights_dir);
+        eval_path = (std::filesystem::temp_directory_path() / "weight_only_teacher.rec").string();
+        if (!write_teacher_set(labeller.model, eval_path, 5000, 12)) return 1;
+    }
+    Dataset eval;
+    if (!eval.open(eval_path)) return 1;
+    if (teacher) std::filesystem::remove(eval_path);   // stays mapped
+
+    EvalRun fp32;
+    std::cout << std::fixed << std::setprecision(4)
+              << "storage  W bytes  resident   accuracy  agreement  latency_ms\n";
+    for (const char* name : { "fp32", "fp16", "bf16", "int8", "int4" }) {
+        WeightStorage storage = WeightStorage::FP32;
+        parse_weight_storage(name, storage);
+        ReferenceNet net(weights_dir, storage, true);
+        Model& model = net.model;
+
+        size_t bytes = 0;
+        for (int l = 0; l < model.num_layers(); ++l) {
+            const DenseLayer& layer = model.layer(l);
+            bytes += layer.packed ? layer.packed->bytes() : layer.W.data.size() * sizeof(float);
+        }
+
+        EvalRun res = run_eval(model, eval);
+        if (storage == WeightStorage::FP32) fp32 = res;
+        std::cout << std::setw(7) << std::left << name << std::right << std::setw(9) << bytes
+                  << std::setw(10) << model.weight_bytes() << "   " << res.accuracy() << "    " << res.agreement(fp32) << "     "
+                  << latency_ms(model, eval) << "\n";
+    }
+    return 0;
+}